@@ -11,6 +11,7 @@ public class GASDocumentation : ModuleRules
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay" });
 
         PrivateDependencyModuleNames.AddRange(new string[] {
+            "AIModule",
             "Slate",
             "SlateCore",
             "GameplayAbilities",
@@ -3,5 +3,7 @@
 #include "GASDocumentation.h"
 #include "Modules/ModuleManager.h"
 
+CSV_DEFINE_CATEGORY_MODULE(GASDOCUMENTATION_API, GASDocumentation, true);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, GASDocumentation, "GASDocumentation" );
  
\ No newline at end of file
@@ -2,7 +2,9 @@
 
 #include "GASDocumentationGameMode.h"
 #include "Engine/World.h"
+#include "GDAssetPreloadSubsystem.h"
 #include "GDHeroCharacter.h"
+#include "GDLoadTestSubsystem.h"
 #include "GDPlayerController.h"
 #include "GDPlayerState.h"
 #include "GameFramework/SpectatorPawn.h"
@@ -14,11 +16,7 @@ AGASDocumentationGameMode::AGASDocumentationGameMode()
 {
 	RespawnDelay = 5.0f;
 
-	HeroClass = StaticLoadClass(UObject::StaticClass(), nullptr, TEXT("/Game/GASDocumentation/Characters/Hero/BP_HeroCharacter.BP_HeroCharacter_C"));
-	if (!HeroClass)
-	{
-		UE_LOG(LogTemp, Error, TEXT("%s() Failed to find HeroClass. If it was moved, please update the reference location in C++."), TEXT(__FUNCTION__));
-	}
+	HeroClass = TSoftClassPtr<AGDHeroCharacter>(FSoftObjectPath(TEXT("/Game/GASDocumentation/Characters/Hero/BP_HeroCharacter.BP_HeroCharacter_C")));
 }
 
 void AGASDocumentationGameMode::HeroDied(AController* Controller)
@@ -58,10 +56,22 @@ void AGASDocumentationGameMode::BeginPlay()
 			break;
 		}
 	}
+
+	if (UGDLoadTestSubsystem* LoadTest = UGDLoadTestSubsystem::Get(this))
+	{
+		LoadTest->StartFromCommandLine();
+	}
 }
 
 void AGASDocumentationGameMode::RespawnHero(AController * Controller)
 {
+	TSubclassOf<AGDHeroCharacter> LoadedHeroClass = UGDAssetPreloadSubsystem::ResolveClass(this, HeroClass);
+	if (!LoadedHeroClass)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s() Failed to find HeroClass. If it was moved, please update the reference location in C++."), TEXT(__FUNCTION__));
+		return;
+	}
+
 	if (Controller->IsPlayerController())
 	{
 		// Respawn player hero
@@ -70,7 +80,7 @@ void AGASDocumentationGameMode::RespawnHero(AController * Controller)
 		FActorSpawnParameters SpawnParameters;
 		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
 
-		AGDHeroCharacter* Hero = GetWorld()->SpawnActor<AGDHeroCharacter>(HeroClass, PlayerStart->GetActorLocation(), PlayerStart->GetActorRotation(), SpawnParameters);
+		AGDHeroCharacter* Hero = GetWorld()->SpawnActor<AGDHeroCharacter>(LoadedHeroClass, PlayerStart->GetActorLocation(), PlayerStart->GetActorRotation(), SpawnParameters);
 
 		APawn* OldSpectatorPawn = Controller->GetPawn();
 		Controller->UnPossess();
@@ -83,7 +93,7 @@ void AGASDocumentationGameMode::RespawnHero(AController * Controller)
 		FActorSpawnParameters SpawnParameters;
 		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
 
-		AGDHeroCharacter* Hero = GetWorld()->SpawnActor<AGDHeroCharacter>(HeroClass, EnemySpawnPoint->GetActorTransform(), SpawnParameters);
+		AGDHeroCharacter* Hero = GetWorld()->SpawnActor<AGDHeroCharacter>(LoadedHeroClass, EnemySpawnPoint->GetActorTransform(), SpawnParameters);
 		
 		APawn* OldSpectatorPawn = Controller->GetPawn();
 		Controller->UnPossess();
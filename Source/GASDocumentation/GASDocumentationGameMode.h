@@ -19,7 +19,8 @@ public:
 protected:
 	float RespawnDelay;
 
-	TSubclassOf<class AGDHeroCharacter> HeroClass;
+	// Preloaded by the GDAssetPreloadSubsystem during map load
+	TSoftClassPtr<class AGDHeroCharacter> HeroClass;
 
 	AActor* EnemySpawnPoint;
 
@@ -0,0 +1,170 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDAIManagerSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GASDocumentation.h"
+#include "GDCharacterBase.h"
+#include "GDHeroAIController.h"
+
+DECLARE_CYCLE_STAT(TEXT("AIManager Tick"), STAT_GDAIManagerTick, STATGROUP_GASDocumentation);
+DECLARE_CYCLE_STAT(TEXT("AIManager Gather Targets"), STAT_GDAIManagerGatherTargets, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("AIManager Decisions"), STAT_GDAIManagerDecisions, STATGROUP_GASDocumentation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("AIManager Controllers"), STAT_GDAIManagerControllers, STATGROUP_GASDocumentation);
+
+UGDAIManagerSubsystem::UGDAIManagerSubsystem()
+{
+	FrameBudgetMilliseconds = 1.0f;
+	MinDecisionsPerFrame = 1;
+	DecisionInterval = 0.25f;
+	NextControllerIndex = 0;
+	TargetCandidatesFrame = 0;
+}
+
+UGDAIManagerSubsystem* UGDAIManagerSubsystem::Get(const AActor* Actor)
+{
+	UGameInstance* GameInstance = Actor ? Actor->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UGDAIManagerSubsystem>() : nullptr;
+}
+
+void UGDAIManagerSubsystem::RegisterController(AGDHeroAIController* Controller)
+{
+	if (!Controller || Controllers.ContainsByPredicate([Controller](const FGDManagedController& Managed) { return Managed.Controller == Controller; }))
+	{
+		return;
+	}
+
+	// Spread the first decisions of controllers that are registered in the same frame over the decision interval
+	UWorld* World = Controller->GetWorld();
+	const double Now = World ? World->GetTimeSeconds() : 0.0;
+	Controllers.Add(FGDManagedController{ Controller, Now + FMath::FRand() * DecisionInterval });
+}
+
+void UGDAIManagerSubsystem::UnregisterController(AGDHeroAIController* Controller)
+{
+	// Removed entries are compacted at the start of the next tick so that the round-robin order isn't disturbed
+	for (FGDManagedController& Managed : Controllers)
+	{
+		if (Managed.Controller == Controller)
+		{
+			Managed.Controller.Reset();
+		}
+	}
+}
+
+int32 UGDAIManagerSubsystem::GetNumControllers() const
+{
+	return Controllers.Num();
+}
+
+void UGDAIManagerSubsystem::Deinitialize()
+{
+	Controllers.Empty();
+	TargetCandidates.Empty();
+
+	Super::Deinitialize();
+}
+
+void UGDAIManagerSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GDAIManagerTick);
+
+	for (int32 Index = Controllers.Num() - 1; Index >= 0; Index--)
+	{
+		if (!Controllers[Index].Controller.IsValid())
+		{
+			Controllers.RemoveAt(Index, 1, false);
+			if (NextControllerIndex > Index)
+			{
+				NextControllerIndex--;
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_GDAIManagerControllers, Controllers.Num());
+
+	if (Controllers.Num() == 0)
+	{
+		NextControllerIndex = 0;
+		return;
+	}
+
+	UWorld* World = GetTickableGameObjectWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	// Decision intervals are in world time so that pause and time dilation apply. The frame budget is real time.
+	const double Now = World->GetTimeSeconds();
+	const double EndTime = FPlatformTime::Seconds() + FrameBudgetMilliseconds / 1000.0;
+	int32 NumDecisions = 0;
+
+	// Visit every controller at most once per frame, starting where the last frame ran out of budget
+	for (int32 NumVisited = 0; NumVisited < Controllers.Num(); NumVisited++)
+	{
+		if (NumDecisions >= MinDecisionsPerFrame && FPlatformTime::Seconds() >= EndTime)
+		{
+			break;
+		}
+
+		NextControllerIndex = NextControllerIndex % Controllers.Num();
+		FGDManagedController& Managed = Controllers[NextControllerIndex++];
+
+		if (!Managed.Controller.IsValid() || Managed.NextDecisionTime > Now)
+		{
+			continue;
+		}
+
+		Managed.NextDecisionTime = Now + DecisionInterval;
+		Managed.Controller->MakeDecision(GetTargetCandidates());
+		NumDecisions++;
+	}
+
+	INC_DWORD_STAT_BY(STAT_GDAIManagerDecisions, NumDecisions);
+}
+
+bool UGDAIManagerSubsystem::IsTickable() const
+{
+	return !HasAnyFlags(RF_ClassDefaultObject) && Controllers.Num() > 0;
+}
+
+TStatId UGDAIManagerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGDAIManagerSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UGDAIManagerSubsystem::GetTickableGameObjectWorld() const
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	return GameInstance ? GameInstance->GetWorld() : nullptr;
+}
+
+const TArray<AGDCharacterBase*>& UGDAIManagerSubsystem::GetTargetCandidates()
+{
+	if (TargetCandidatesFrame == GFrameCounter)
+	{
+		return TargetCandidates;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_GDAIManagerGatherTargets);
+
+	TargetCandidatesFrame = GFrameCounter;
+	TargetCandidates.Reset();
+
+	UWorld* World = GetTickableGameObjectWorld();
+	if (World)
+	{
+		for (TActorIterator<AGDCharacterBase> It(World); It; ++It)
+		{
+			if (It->IsAlive())
+			{
+				TargetCandidates.Add(*It);
+			}
+		}
+	}
+
+	return TargetCandidates;
+}
@@ -2,8 +2,152 @@
 
 
 #include "GDHeroAIController.h"
+#include "AbilitySystemComponent.h"
+#include "GDAIManagerSubsystem.h"
+#include "GDCharacterBase.h"
+#include "GDHeroCharacter.h"
 
 AGDHeroAIController::AGDHeroAIController()
 {
 	bWantsPlayerState = true;
-}
\ No newline at end of file
+
+	// Meteor (Ability5) waits for a target confirm and AimDownSight (Ability2) for an input release that the AI never sends
+	AbilityPriority = { EGDAbilityInputID::Ability4, EGDAbilityInputID::Ability3, EGDAbilityInputID::Ability1 };
+	AcquireRadius = 5000.0f;
+	AttackRange = 1500.0f;
+}
+
+AGDCharacterBase* AGDHeroAIController::GetTarget() const
+{
+	return Target.Get();
+}
+
+void AGDHeroAIController::MakeDecision(const TArray<AGDCharacterBase*>& Candidates)
+{
+	AGDCharacterBase* Hero = Cast<AGDCharacterBase>(GetPawn());
+	if (!Hero || !Hero->IsAlive())
+	{
+		return;
+	}
+
+	AGDCharacterBase* NewTarget = UpdateTarget(Hero, Candidates);
+	if (!NewTarget)
+	{
+		ClearFocus(EAIFocusPriority::Gameplay);
+		StopMovement();
+		return;
+	}
+
+	SetFocus(NewTarget);
+
+	if (FVector::DistSquared(Hero->GetActorLocation(), NewTarget->GetActorLocation()) > FMath::Square(AttackRange))
+	{
+		MoveToActor(NewTarget, AttackRange * 0.8f);
+		return;
+	}
+
+	StopMovement();
+	TryActivateAbilityByPriority(Hero);
+}
+
+void AGDHeroAIController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	if (Role == ROLE_Authority)
+	{
+		if (UGDAIManagerSubsystem* AIManager = UGDAIManagerSubsystem::Get(this))
+		{
+			AIManager->RegisterController(this);
+		}
+	}
+}
+
+void AGDHeroAIController::OnUnPossess()
+{
+	if (UGDAIManagerSubsystem* AIManager = UGDAIManagerSubsystem::Get(this))
+	{
+		AIManager->UnregisterController(this);
+	}
+
+	Target.Reset();
+
+	Super::OnUnPossess();
+}
+
+void AGDHeroAIController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UGDAIManagerSubsystem* AIManager = UGDAIManagerSubsystem::Get(this))
+	{
+		AIManager->UnregisterController(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+AGDCharacterBase* AGDHeroAIController::UpdateTarget(const AGDCharacterBase* Hero, const TArray<AGDCharacterBase*>& Candidates)
+{
+	const FVector HeroLocation = Hero->GetActorLocation();
+	const float AcquireRadiusSquared = FMath::Square(AcquireRadius);
+
+	AGDCharacterBase* CurrentTarget = Target.Get();
+	if (CurrentTarget && CurrentTarget->IsAlive() && IsHostile(Hero, CurrentTarget) && FVector::DistSquared(HeroLocation, CurrentTarget->GetActorLocation()) <= AcquireRadiusSquared)
+	{
+		return CurrentTarget;
+	}
+
+	AGDCharacterBase* ClosestCandidate = nullptr;
+	float ClosestDistanceSquared = AcquireRadiusSquared;
+
+	for (AGDCharacterBase* Candidate : Candidates)
+	{
+		if (Candidate == Hero || !IsHostile(Hero, Candidate))
+		{
+			continue;
+		}
+
+		const float DistanceSquared = FVector::DistSquared(HeroLocation, Candidate->GetActorLocation());
+		if (DistanceSquared <= ClosestDistanceSquared)
+		{
+			ClosestCandidate = Candidate;
+			ClosestDistanceSquared = DistanceSquared;
+		}
+	}
+
+	Target = ClosestCandidate;
+	return ClosestCandidate;
+}
+
+bool AGDHeroAIController::IsHostile(const AGDCharacterBase* Hero, const AGDCharacterBase* Candidate) const
+{
+	// Heroes (players and bots) are on one side and minions on the other
+	return !Candidate->IsA<AGDHeroCharacter>();
+}
+
+bool AGDHeroAIController::TryActivateAbilityByPriority(AGDCharacterBase* Hero)
+{
+	UAbilitySystemComponent* ASC = Hero->GetAbilitySystemComponent();
+	if (!ASC)
+	{
+		return false;
+	}
+
+	for (EGDAbilityInputID InputID : AbilityPriority)
+	{
+		for (const FGameplayAbilitySpec& Spec : ASC->GetActivatableAbilities())
+		{
+			if (Spec.InputID != static_cast<int32>(InputID) || Spec.IsActive())
+			{
+				continue;
+			}
+
+			// Cooldowns, costs and blocking tags are checked by TryActivateAbility
+			if (ASC->TryActivateAbility(Spec.Handle))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
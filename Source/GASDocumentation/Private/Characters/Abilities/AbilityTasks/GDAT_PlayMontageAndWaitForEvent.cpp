@@ -10,11 +10,18 @@
 #include "AbilitySystemGlobals.h"
 #include "Animation/AnimInstance.h"
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Montage Tasks Created"), STAT_GDMontageTasksCreated, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Montage Task Restarts"), STAT_GDMontageTaskRestarts, STATGROUP_GASDocumentation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Montage Tasks Created Total"), STAT_GDMontageTasksCreatedTotal, STATGROUP_GASDocumentation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Montage Task Restarts Total"), STAT_GDMontageTaskRestartsTotal, STATGROUP_GASDocumentation);
+
 UGDAT_PlayMontageAndWaitForEvent::UGDAT_PlayMontageAndWaitForEvent(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 	Rate = 1.f;
 	bStopWhenAbilityEnds = true;
+	bExactEventTagMatch = false;
+	MontagePlaySerial = 0;
 }
 
 UGDAbilitySystemComponent* UGDAT_PlayMontageAndWaitForEvent::GetTargetASC()
@@ -22,8 +29,13 @@ UGDAbilitySystemComponent* UGDAT_PlayMontageAndWaitForEvent::GetTargetASC()
 	return Cast<UGDAbilitySystemComponent>(AbilitySystemComponent);
 }
 
-void UGDAT_PlayMontageAndWaitForEvent::OnMontageBlendingOut(UAnimMontage* Montage, bool bInterrupted)
+void UGDAT_PlayMontageAndWaitForEvent::OnMontageBlendingOut(UAnimMontage* Montage, bool bInterrupted, uint32 PlaySerial)
 {
+	if (PlaySerial != MontagePlaySerial)
+	{
+		return;
+	}
+
 	if (Ability && Ability->GetCurrentMontage() == MontageToPlay)
 	{
 		if (Montage == MontageToPlay)
@@ -45,14 +57,14 @@ void UGDAT_PlayMontageAndWaitForEvent::OnMontageBlendingOut(UAnimMontage* Montag
 	{
 		if (ShouldBroadcastAbilityTaskDelegates())
 		{
-			OnInterrupted.Broadcast(FGameplayTag(), FGameplayEventData());
+			BroadcastMontageState(OnInterrupted, OnInterruptedNative);
 		}
 	}
 	else
 	{
 		if (ShouldBroadcastAbilityTaskDelegates())
 		{
-			OnBlendOut.Broadcast(FGameplayTag(), FGameplayEventData());
+			BroadcastMontageState(OnBlendOut, OnBlendOutNative);
 		}
 	}
 }
@@ -66,21 +78,32 @@ void UGDAT_PlayMontageAndWaitForEvent::OnAbilityCancelled()
 		// Let the BP handle the interrupt as well
 		if (ShouldBroadcastAbilityTaskDelegates())
 		{
-			OnCancelled.Broadcast(FGameplayTag(), FGameplayEventData());
+			BroadcastMontageState(OnCancelled, OnCancelledNative);
 		}
 	}
 }
 
-void UGDAT_PlayMontageAndWaitForEvent::OnMontageEnded(UAnimMontage* Montage, bool bInterrupted)
+void UGDAT_PlayMontageAndWaitForEvent::OnMontageEnded(UAnimMontage* Montage, bool bInterrupted, uint32 PlaySerial)
 {
+	if (PlaySerial != MontagePlaySerial)
+	{
+		return;
+	}
+
 	if (!bInterrupted)
 	{
 		if (ShouldBroadcastAbilityTaskDelegates())
 		{
-			OnCompleted.Broadcast(FGameplayTag(), FGameplayEventData());
+			BroadcastMontageState(OnCompleted, OnCompletedNative);
 		}
 	}
 
+	// A listener restarted the montage, keep the task alive for it
+	if (PlaySerial != MontagePlaySerial)
+	{
+		return;
+	}
+
 	EndTask();
 }
 
@@ -88,25 +111,91 @@ void UGDAT_PlayMontageAndWaitForEvent::OnGameplayEvent(FGameplayTag EventTag, co
 {
 	if (ShouldBroadcastAbilityTaskDelegates())
 	{
-		FGameplayEventData TempData = *Payload;
-		TempData.EventTag = EventTag;
+		BroadcastEvent(EventTag, *Payload);
+	}
+}
+
+void UGDAT_PlayMontageAndWaitForEvent::OnExactGameplayEvent(const FGameplayEventData* Payload, FGameplayTag EventTag)
+{
+	if (ShouldBroadcastAbilityTaskDelegates())
+	{
+		BroadcastEvent(EventTag, *Payload);
+	}
+}
+
+void UGDAT_PlayMontageAndWaitForEvent::BroadcastEvent(FGameplayTag EventTag, const FGameplayEventData& EventData)
+{
+	EventReceivedNative.Broadcast(EventTag, EventData);
+
+	// Dynamic delegates take the payload by value, so only pay for the copy if Blueprint is listening
+	if (EventReceived.IsBound() && ShouldBroadcastAbilityTaskDelegates())
+	{
+		if (EventData.EventTag == EventTag)
+		{
+			EventReceived.Broadcast(EventTag, EventData);
+		}
+		else
+		{
+			FGameplayEventData TempData = EventData;
+			TempData.EventTag = EventTag;
+
+			EventReceived.Broadcast(EventTag, TempData);
+		}
+	}
+}
+
+void UGDAT_PlayMontageAndWaitForEvent::BroadcastMontageState(FGDPlayMontageAndWaitForEventDelegate& Delegate, FGDPlayMontageAndWaitForEventNativeDelegate& NativeDelegate)
+{
+	static const FGameplayEventData EmptyEventData;
+
+	NativeDelegate.Broadcast(FGameplayTag(), EmptyEventData);
+
+	if (Delegate.IsBound() && ShouldBroadcastAbilityTaskDelegates())
+	{
+		Delegate.Broadcast(FGameplayTag(), EmptyEventData);
+	}
+}
+
+void UGDAT_PlayMontageAndWaitForEvent::RemoveEventDelegates()
+{
+	UGDAbilitySystemComponent* GDAbilitySystemComponent = GetTargetASC();
+	if (GDAbilitySystemComponent)
+	{
+		if (EventHandle.IsValid())
+		{
+			GDAbilitySystemComponent->RemoveGameplayEventTagContainerDelegate(EventTags, EventHandle);
+		}
 
-		EventReceived.Broadcast(EventTag, TempData);
+		for (const TPair<FGameplayTag, FDelegateHandle>& ExactEventHandle : ExactEventHandles)
+		{
+			FGameplayEventMulticastDelegate* Delegate = GDAbilitySystemComponent->GenericGameplayEventCallbacks.Find(ExactEventHandle.Key);
+			if (Delegate)
+			{
+				Delegate->Remove(ExactEventHandle.Value);
+			}
+		}
 	}
+
+	EventHandle.Reset();
+	ExactEventHandles.Reset();
 }
 
 UGDAT_PlayMontageAndWaitForEvent* UGDAT_PlayMontageAndWaitForEvent::PlayMontageAndWaitForEvent(UGameplayAbility* OwningAbility,
-	FName TaskInstanceName, UAnimMontage* MontageToPlay, FGameplayTagContainer EventTags, float Rate, FName StartSection, bool bStopWhenAbilityEnds, float AnimRootMotionTranslationScale)
+	FName TaskInstanceName, UAnimMontage* MontageToPlay, FGameplayTagContainer EventTags, float Rate, FName StartSection, bool bStopWhenAbilityEnds, float AnimRootMotionTranslationScale,
+	bool bExactEventTagMatch)
 {
 	UAbilitySystemGlobals::NonShipping_ApplyGlobalAbilityScaler_Rate(Rate);
 
 	UGDAT_PlayMontageAndWaitForEvent* MyObj = NewAbilityTask<UGDAT_PlayMontageAndWaitForEvent>(OwningAbility, TaskInstanceName);
+	INC_DWORD_STAT(STAT_GDMontageTasksCreated);
+	INC_DWORD_STAT(STAT_GDMontageTasksCreatedTotal);
 	MyObj->MontageToPlay = MontageToPlay;
 	MyObj->EventTags = EventTags;
 	MyObj->Rate = Rate;
 	MyObj->StartSection = StartSection;
 	MyObj->AnimRootMotionTranslationScale = AnimRootMotionTranslationScale;
 	MyObj->bStopWhenAbilityEnds = bStopWhenAbilityEnds;
+	MyObj->bExactEventTagMatch = bExactEventTagMatch && !EventTags.IsEmpty();
 
 	return MyObj;
 }
@@ -128,9 +217,21 @@ void UGDAT_PlayMontageAndWaitForEvent::Activate()
 		if (AnimInstance != nullptr)
 		{
 			// Bind to event callback
-			EventHandle = GDAbilitySystemComponent->AddGameplayEventTagContainerDelegate(EventTags, FGameplayEventTagMulticastDelegate::FDelegate::CreateUObject(this, &UGDAT_PlayMontageAndWaitForEvent::OnGameplayEvent));
+			if (bExactEventTagMatch)
+			{
+				// The ASC looks these up by the event's tag, so events we don't care about never reach this task
+				for (const FGameplayTag& EventTag : EventTags)
+				{
+					FDelegateHandle Handle = GDAbilitySystemComponent->GenericGameplayEventCallbacks.FindOrAdd(EventTag).AddUObject(this, &UGDAT_PlayMontageAndWaitForEvent::OnExactGameplayEvent, EventTag);
+					ExactEventHandles.Add(TPair<FGameplayTag, FDelegateHandle>(EventTag, Handle));
+				}
+			}
+			else
+			{
+				EventHandle = GDAbilitySystemComponent->AddGameplayEventTagContainerDelegate(EventTags, FGameplayEventTagMulticastDelegate::FDelegate::CreateUObject(this, &UGDAT_PlayMontageAndWaitForEvent::OnGameplayEvent));
+			}
 
-			if (GDAbilitySystemComponent->PlayMontage(Ability, Ability->GetCurrentActivationInfo(), MontageToPlay, Rate, StartSection) > 0.f)
+			if (PlayMontage(GDAbilitySystemComponent, AnimInstance))
 			{
 				// Playing a montage could potentially fire off a callback into game code which could kill this ability! Early out if we are  pending kill.
 				if (ShouldBroadcastAbilityTaskDelegates() == false)
@@ -140,19 +241,6 @@ void UGDAT_PlayMontageAndWaitForEvent::Activate()
 
 				CancelledHandle = Ability->OnGameplayAbilityCancelled.AddUObject(this, &UGDAT_PlayMontageAndWaitForEvent::OnAbilityCancelled);
 
-				BlendingOutDelegate.BindUObject(this, &UGDAT_PlayMontageAndWaitForEvent::OnMontageBlendingOut);
-				AnimInstance->Montage_SetBlendingOutDelegate(BlendingOutDelegate, MontageToPlay);
-
-				MontageEndedDelegate.BindUObject(this, &UGDAT_PlayMontageAndWaitForEvent::OnMontageEnded);
-				AnimInstance->Montage_SetEndDelegate(MontageEndedDelegate, MontageToPlay);
-
-				ACharacter* Character = Cast<ACharacter>(GetAvatarActor());
-				if (Character && (Character->Role == ROLE_Authority ||
-					(Character->Role == ROLE_AutonomousProxy && Ability->GetNetExecutionPolicy() == EGameplayAbilityNetExecutionPolicy::LocalPredicted)))
-				{
-					Character->SetAnimRootMotionTranslationScale(AnimRootMotionTranslationScale);
-				}
-
 				bPlayedMontage = true;
 			}
 		}
@@ -172,13 +260,82 @@ void UGDAT_PlayMontageAndWaitForEvent::Activate()
 		if (ShouldBroadcastAbilityTaskDelegates())
 		{
 			//ABILITY_LOG(Display, TEXT("%s: OnCancelled"), *GetName());
-			OnCancelled.Broadcast(FGameplayTag(), FGameplayEventData());
+			BroadcastMontageState(OnCancelled, OnCancelledNative);
 		}
 	}
 
 	SetWaitingOnAvatar();
 }
 
+bool UGDAT_PlayMontageAndWaitForEvent::RestartMontage(UAnimMontage* NewMontageToPlay, float NewRate, FName NewStartSection)
+{
+	if (!IsActive() || Ability == nullptr)
+	{
+		return false;
+	}
+
+	UGDAbilitySystemComponent* GDAbilitySystemComponent = GetTargetASC();
+	const FGameplayAbilityActorInfo* ActorInfo = Ability->GetCurrentActorInfo();
+	UAnimInstance* AnimInstance = ActorInfo ? ActorInfo->GetAnimInstance() : nullptr;
+	if (!GDAbilitySystemComponent || !AnimInstance)
+	{
+		return false;
+	}
+
+	// Stop listening to the previous montage. Callbacks it already queued are ignored because the serial changes.
+	FAnimMontageInstance* MontageInstance = AnimInstance->GetActiveInstanceForMontage(MontageToPlay);
+	if (MontageInstance)
+	{
+		MontageInstance->OnMontageBlendingOutStarted.Unbind();
+		MontageInstance->OnMontageEnded.Unbind();
+	}
+
+	UAbilitySystemGlobals::NonShipping_ApplyGlobalAbilityScaler_Rate(NewRate);
+
+	if (NewMontageToPlay)
+	{
+		MontageToPlay = NewMontageToPlay;
+	}
+	Rate = NewRate;
+	StartSection = NewStartSection;
+
+	INC_DWORD_STAT(STAT_GDMontageTaskRestarts);
+	INC_DWORD_STAT(STAT_GDMontageTaskRestartsTotal);
+
+	return PlayMontage(GDAbilitySystemComponent, AnimInstance);
+}
+
+bool UGDAT_PlayMontageAndWaitForEvent::PlayMontage(UGDAbilitySystemComponent* GDAbilitySystemComponent, UAnimInstance* AnimInstance)
+{
+	// Invalidate callbacks from anything played before
+	MontagePlaySerial++;
+
+	if (GDAbilitySystemComponent->PlayMontage(Ability, Ability->GetCurrentActivationInfo(), MontageToPlay, Rate, StartSection) <= 0.f)
+	{
+		return false;
+	}
+
+	if (ShouldBroadcastAbilityTaskDelegates() == false)
+	{
+		return true;
+	}
+
+	BlendingOutDelegate.BindUObject(this, &UGDAT_PlayMontageAndWaitForEvent::OnMontageBlendingOut, MontagePlaySerial);
+	AnimInstance->Montage_SetBlendingOutDelegate(BlendingOutDelegate, MontageToPlay);
+
+	MontageEndedDelegate.BindUObject(this, &UGDAT_PlayMontageAndWaitForEvent::OnMontageEnded, MontagePlaySerial);
+	AnimInstance->Montage_SetEndDelegate(MontageEndedDelegate, MontageToPlay);
+
+	ACharacter* Character = Cast<ACharacter>(GetAvatarActor());
+	if (Character && (Character->Role == ROLE_Authority ||
+		(Character->Role == ROLE_AutonomousProxy && Ability->GetNetExecutionPolicy() == EGameplayAbilityNetExecutionPolicy::LocalPredicted)))
+	{
+		Character->SetAnimRootMotionTranslationScale(AnimRootMotionTranslationScale);
+	}
+
+	return true;
+}
+
 void UGDAT_PlayMontageAndWaitForEvent::ExternalCancel()
 {
 	check(AbilitySystemComponent);
@@ -203,11 +360,7 @@ void UGDAT_PlayMontageAndWaitForEvent::OnDestroy(bool AbilityEnded)
 		}
 	}
 
-	UGDAbilitySystemComponent* GDAbilitySystemComponent = GetTargetASC();
-	if (GDAbilitySystemComponent)
-	{
-		GDAbilitySystemComponent->RemoveGameplayEventTagContainerDelegate(EventTags, EventHandle);
-	}
+	RemoveEventDelegates();
 
 	Super::OnDestroy(AbilityEnded);
 
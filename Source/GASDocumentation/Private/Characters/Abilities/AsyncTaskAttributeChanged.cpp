@@ -2,12 +2,16 @@
 
 
 #include "AsyncTaskAttributeChanged.h"
+#include "Engine/World.h"
+#include "GDAbilitySystemComponent.h"
+#include "TimerManager.h"
 
 UAsyncTaskAttributeChanged* UAsyncTaskAttributeChanged::ListenForAttributeChange(UAbilitySystemComponent* AbilitySystemComponent, FGameplayAttribute Attribute)
 {
 	UAsyncTaskAttributeChanged* WaitForAttributeChangedTask = NewObject<UAsyncTaskAttributeChanged>();
 	WaitForAttributeChangedTask->ASC = AbilitySystemComponent;
 	WaitForAttributeChangedTask->AttributeToListenFor = Attribute;
+	WaitForAttributeChangedTask->CoalesceChanges = false;
 
 	if (!IsValid(AbilitySystemComponent) || !Attribute.IsValid())
 	{
@@ -15,7 +19,7 @@ UAsyncTaskAttributeChanged* UAsyncTaskAttributeChanged::ListenForAttributeChange
 		return nullptr;
 	}
 
-	AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(Attribute).AddUObject(WaitForAttributeChangedTask, &UAsyncTaskAttributeChanged::AttributeChanged);
+	WaitForAttributeChangedTask->StartListening();
 
 	return WaitForAttributeChangedTask;
 }
@@ -25,6 +29,7 @@ UAsyncTaskAttributeChanged * UAsyncTaskAttributeChanged::ListenForAttributesChan
 	UAsyncTaskAttributeChanged* WaitForAttributeChangedTask = NewObject<UAsyncTaskAttributeChanged>();
 	WaitForAttributeChangedTask->ASC = AbilitySystemComponent;
 	WaitForAttributeChangedTask->AttributesToListenFor = Attributes;
+	WaitForAttributeChangedTask->CoalesceChanges = false;
 
 	if (!IsValid(AbilitySystemComponent) || Attributes.Num() < 1)
 	{
@@ -32,30 +37,128 @@ UAsyncTaskAttributeChanged * UAsyncTaskAttributeChanged::ListenForAttributesChan
 		return nullptr;
 	}
 
-	for (FGameplayAttribute Attribute : Attributes)
+	WaitForAttributeChangedTask->StartListening();
+
+	return WaitForAttributeChangedTask;
+}
+
+UAsyncTaskAttributeChanged* UAsyncTaskAttributeChanged::ListenForAttributesChangeCoalesced(UAbilitySystemComponent* AbilitySystemComponent, TArray<FGameplayAttribute> Attributes)
+{
+	UAsyncTaskAttributeChanged* WaitForAttributeChangedTask = ListenForAttributesChange(AbilitySystemComponent, Attributes);
+	if (WaitForAttributeChangedTask)
 	{
-		AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(Attribute).AddUObject(WaitForAttributeChangedTask, &UAsyncTaskAttributeChanged::AttributeChanged);
+		WaitForAttributeChangedTask->CoalesceChanges = true;
 	}
 
 	return WaitForAttributeChangedTask;
 }
 
+void UAsyncTaskAttributeChanged::EndTask()
+{
+	StopListening();
+
+	SetReadyToDestroy();
+	MarkPendingKill();
+}
+
 void UAsyncTaskAttributeChanged::BeginDestroy()
+{
+	StopListening();
+
+	Super::BeginDestroy();
+}
+
+void UAsyncTaskAttributeChanged::StartListening()
+{
+	UGDAbilitySystemComponent* GDASC = Cast<UGDAbilitySystemComponent>(ASC);
+
+	TArray<FGameplayAttribute> Attributes = AttributesToListenFor;
+	if (AttributeToListenFor.IsValid())
+	{
+		Attributes.AddUnique(AttributeToListenFor);
+	}
+
+	for (const FGameplayAttribute& Attribute : Attributes)
+	{
+		if (GDASC)
+		{
+			GDASC->AddAttributeChangeListener(Attribute, this);
+		}
+		else
+		{
+			ASC->GetGameplayAttributeValueChangeDelegate(Attribute).AddUObject(this, &UAsyncTaskAttributeChanged::AttributeChanged);
+		}
+	}
+}
+
+void UAsyncTaskAttributeChanged::StopListening()
 {
 	if (IsValid(ASC))
 	{
-		ASC->GetGameplayAttributeValueChangeDelegate(AttributeToListenFor).RemoveAll(this);
+		UGDAbilitySystemComponent* GDASC = Cast<UGDAbilitySystemComponent>(ASC);
+		if (GDASC)
+		{
+			GDASC->RemoveAttributeChangeListener(this);
+		}
+		else
+		{
+			ASC->GetGameplayAttributeValueChangeDelegate(AttributeToListenFor).RemoveAll(this);
 
-		for (FGameplayAttribute Attribute : AttributesToListenFor)
+			for (FGameplayAttribute Attribute : AttributesToListenFor)
+			{
+				ASC->GetGameplayAttributeValueChangeDelegate(Attribute).RemoveAll(this);
+			}
+		}
+
+		UWorld* World = ASC->GetWorld();
+		if (World)
 		{
-			ASC->GetGameplayAttributeValueChangeDelegate(Attribute).RemoveAll(this);
+			World->GetTimerManager().ClearTimer(FlushPendingChangesTimerHandle);
 		}
 	}
 
-	Super::BeginDestroy();
+	PendingChanges.Reset();
 }
 
 void UAsyncTaskAttributeChanged::AttributeChanged(const FOnAttributeChangeData & Data)
 {
-	OnAttributeChanged.Broadcast(Data.Attribute, Data.NewValue, Data.OldValue);
-}
\ No newline at end of file
+	UWorld* World = CoalesceChanges && ASC ? ASC->GetWorld() : nullptr;
+	if (!World)
+	{
+		OnAttributeChanged.Broadcast(Data.Attribute, Data.NewValue, Data.OldValue);
+		return;
+	}
+
+	FPendingAttributeChange* PendingChange = PendingChanges.FindByPredicate([&Data](const FPendingAttributeChange& Change)
+	{
+		return Change.Attribute == Data.Attribute;
+	});
+
+	if (PendingChange)
+	{
+		PendingChange->NewValue = Data.NewValue;
+	}
+	else
+	{
+		PendingChanges.Add(FPendingAttributeChange{ Data.Attribute, Data.NewValue, Data.OldValue });
+	}
+
+	if (!FlushPendingChangesTimerHandle.IsValid())
+	{
+		FlushPendingChangesTimerHandle = World->GetTimerManager().SetTimerForNextTick(FTimerDelegate::CreateUObject(this, &UAsyncTaskAttributeChanged::FlushPendingChanges));
+	}
+}
+
+void UAsyncTaskAttributeChanged::FlushPendingChanges()
+{
+	FlushPendingChangesTimerHandle.Invalidate();
+
+	// Listeners can change attributes in response. Those changes go out next tick.
+	TArray<FPendingAttributeChange> ChangesToBroadcast = MoveTemp(PendingChanges);
+	PendingChanges.Reset();
+
+	for (const FPendingAttributeChange& Change : ChangesToBroadcast)
+	{
+		OnAttributeChanged.Broadcast(Change.Attribute, Change.NewValue, Change.OldValue);
+	}
+}
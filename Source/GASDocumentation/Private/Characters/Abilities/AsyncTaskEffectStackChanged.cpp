@@ -2,6 +2,7 @@
 
 
 #include "AsyncTaskEffectStackChanged.h"
+#include "GDAbilitySystemComponent.h"
 
 UAsyncTaskEffectStackChanged * UAsyncTaskEffectStackChanged::ListenForGameplayEffectStackChange(UAbilitySystemComponent * AbilitySystemComponent, FGameplayTag InEffectGameplayTag)
 {
@@ -15,12 +16,53 @@ UAsyncTaskEffectStackChanged * UAsyncTaskEffectStackChanged::ListenForGameplayEf
 		return nullptr;
 	}
 
+	// GDAbilitySystemComponents keep an index from tags to active effects so that we don't check every effect's tags for every listener
+	UGDAbilitySystemComponent* GDASC = Cast<UGDAbilitySystemComponent>(AbilitySystemComponent);
+	if (GDASC)
+	{
+		GDASC->AddEffectStackChangeListener(InEffectGameplayTag, ListenForGameplayEffectStackChange);
+		return ListenForGameplayEffectStackChange;
+	}
+
 	AbilitySystemComponent->OnActiveGameplayEffectAddedDelegateToSelf.AddUObject(ListenForGameplayEffectStackChange, &UAsyncTaskEffectStackChanged::OnActiveGameplayEffectAddedCallback);
 	AbilitySystemComponent->OnAnyGameplayEffectRemovedDelegate().AddUObject(ListenForGameplayEffectStackChange, &UAsyncTaskEffectStackChanged::OnRemoveGameplayEffectCallback);
 
 	return ListenForGameplayEffectStackChange;
 }
 
+void UAsyncTaskEffectStackChanged::EndTask()
+{
+	StopListening();
+
+	SetReadyToDestroy();
+	MarkPendingKill();
+}
+
+void UAsyncTaskEffectStackChanged::BeginDestroy()
+{
+	StopListening();
+
+	Super::BeginDestroy();
+}
+
+void UAsyncTaskEffectStackChanged::StopListening()
+{
+	if (!IsValid(ASC))
+	{
+		return;
+	}
+
+	UGDAbilitySystemComponent* GDASC = Cast<UGDAbilitySystemComponent>(ASC);
+	if (GDASC)
+	{
+		GDASC->RemoveEffectStackChangeListener(this);
+		return;
+	}
+
+	ASC->OnActiveGameplayEffectAddedDelegateToSelf.RemoveAll(this);
+	ASC->OnAnyGameplayEffectRemovedDelegate().RemoveAll(this);
+}
+
 void UAsyncTaskEffectStackChanged::OnActiveGameplayEffectAddedCallback(UAbilitySystemComponent * Target, const FGameplayEffectSpec & SpecApplied, FActiveGameplayEffectHandle ActiveHandle)
 {
 	FGameplayTagContainer AssetTags;
@@ -4,9 +4,118 @@
 #include "GDAttributeSetBase.h"
 #include "GameplayEffect.h"
 #include "GameplayEffectExtension.h"
+#include "GASDocumentation.h"
+#include "GDAbilitySystemComponent.h"
 #include "GDCharacterBase.h"
+#include "GDCombatRules.h"
+#include "GDCombatEventSubsystem.h"
 #include "GDPlayerController.h"
 #include "UnrealNetwork.h"
+#include "UObject/UnrealType.h"
+
+DECLARE_CYCLE_STAT(TEXT("PostGameplayEffectExecute"), STAT_GDPostGameplayEffectExecute, STATGROUP_GASDocumentation);
+
+// What happens when one attribute changes. Only attributes with a rule have anything to do.
+struct FGDAttributeRule
+{
+	// PreAttributeChange: the current attribute to rescale when this max attribute changes
+	FGameplayAttribute RescaledAttribute;
+
+	// PreAttributeChange: clamp the new value
+	bool bClampPreChange = false;
+	float PreChangeMin = 0.0f;
+	float PreChangeMax = 0.0f;
+
+	// PostGameplayEffectExecute: called for executions that modified this attribute
+	void (UGDAttributeSetBase::*PostExecuteHandler)(const FGameplayEffectModCallbackData& Data) = nullptr;
+
+	// PostGameplayEffectExecute: clamp this attribute to [0, PostExecuteMaxAttribute]
+	FGameplayAttribute PostExecuteMaxAttribute;
+};
+
+// Rules indexed by the attribute property's offset in UGDAttributeSetBase so that finding one is a single array lookup
+// instead of comparing against every attribute. Built once the first time an attribute changes.
+struct FGDAttributeRuleTable
+{
+	TArray<FGDAttributeRule> Rules;
+
+	// Property of each entry in Rules, to reject attributes from other attribute sets that happen to map to a valid index
+	TArray<UProperty*> Properties;
+
+	int32 BaseOffset;
+
+	FGDAttributeRuleTable()
+	{
+		BaseOffset = MAX_int32;
+		int32 MaxOffset = 0;
+		for (TFieldIterator<UStructProperty> It(UGDAttributeSetBase::StaticClass(), EFieldIteratorFlags::ExcludeSuper); It; ++It)
+		{
+			if (It->Struct == FGameplayAttributeData::StaticStruct())
+			{
+				BaseOffset = FMath::Min(BaseOffset, It->GetOffset_ForInternal());
+				MaxOffset = FMath::Max(MaxOffset, It->GetOffset_ForInternal());
+			}
+		}
+
+		if (BaseOffset > MaxOffset)
+		{
+			return;
+		}
+
+		Rules.SetNum(GetIndex(MaxOffset) + 1);
+		Properties.SetNumZeroed(Rules.Num());
+
+		FGDAttributeRule& MaxHealthRule = AddRule(UGDAttributeSetBase::GetMaxHealthAttribute());
+		MaxHealthRule.RescaledAttribute = UGDAttributeSetBase::GetHealthAttribute();
+
+		FGDAttributeRule& MaxManaRule = AddRule(UGDAttributeSetBase::GetMaxManaAttribute());
+		MaxManaRule.RescaledAttribute = UGDAttributeSetBase::GetManaAttribute();
+
+		FGDAttributeRule& MaxStaminaRule = AddRule(UGDAttributeSetBase::GetMaxStaminaAttribute());
+		MaxStaminaRule.RescaledAttribute = UGDAttributeSetBase::GetStaminaAttribute();
+
+		// Cannot slow less than 150 units/s and cannot boost more than 1000 units/s
+		FGDAttributeRule& MoveSpeedRule = AddRule(UGDAttributeSetBase::GetMoveSpeedAttribute());
+		MoveSpeedRule.bClampPreChange = true;
+		MoveSpeedRule.PreChangeMin = 150.0f;
+		MoveSpeedRule.PreChangeMax = 1000.0f;
+
+		FGDAttributeRule& DamageRule = AddRule(UGDAttributeSetBase::GetDamageAttribute());
+		DamageRule.PostExecuteHandler = &UGDAttributeSetBase::HandleDamageExecuted;
+
+		AddRule(UGDAttributeSetBase::GetHealthAttribute()).PostExecuteMaxAttribute = UGDAttributeSetBase::GetMaxHealthAttribute();
+		AddRule(UGDAttributeSetBase::GetManaAttribute()).PostExecuteMaxAttribute = UGDAttributeSetBase::GetMaxManaAttribute();
+		AddRule(UGDAttributeSetBase::GetStaminaAttribute()).PostExecuteMaxAttribute = UGDAttributeSetBase::GetMaxStaminaAttribute();
+	}
+
+	int32 GetIndex(int32 Offset) const
+	{
+		const int32 Stride = sizeof(FGameplayAttributeData);
+		const int32 Delta = Offset - BaseOffset;
+		return Delta >= 0 && Delta % Stride == 0 ? Delta / Stride : INDEX_NONE;
+	}
+
+	FGDAttributeRule& AddRule(const FGameplayAttribute& Attribute)
+	{
+		const int32 Index = GetIndex(Attribute.GetUProperty()->GetOffset_ForInternal());
+		check(Rules.IsValidIndex(Index));
+
+		Properties[Index] = Attribute.GetUProperty();
+		return Rules[Index];
+	}
+
+	const FGDAttributeRule* Find(const FGameplayAttribute& Attribute) const
+	{
+		UProperty* Property = Attribute.GetUProperty();
+		if (!Property)
+		{
+			return nullptr;
+		}
+
+		const int32 Index = GetIndex(Property->GetOffset_ForInternal());
+		return Properties.IsValidIndex(Index) && Properties[Index] == Property ? &Rules[Index] : nullptr;
+	}
+};
 
 UGDAttributeSetBase::UGDAttributeSetBase()
 {
@@ -22,23 +131,25 @@ void UGDAttributeSetBase::PreAttributeChange(const FGameplayAttribute& Attribute
 	// This is called whenever attributes change, so for max health/mana we want to scale the current totals to match
 	Super::PreAttributeChange(Attribute, NewValue);
 
-	// If a Max value changes, adjust current to keep Current % of Current to Max
-	if (Attribute == GetMaxHealthAttribute()) // GetMaxHealthAttribute comes from the Macros defined at the top of the header
+	const FGDAttributeRule* Rule = FindAttributeRule(Attribute);
+	if (!Rule)
 	{
-		AdjustAttributeForMaxChange(Health, MaxHealth, NewValue, GetHealthAttribute());
+		return;
 	}
-	else if (Attribute == GetMaxManaAttribute())
+
+	// If a Max value changes, adjust current to keep Current % of Current to Max
+	if (Rule->RescaledAttribute.IsValid() && MaxAttributeRescaleScopeDepth > 0)
 	{
-		AdjustAttributeForMaxChange(Mana, MaxMana, NewValue, GetManaAttribute());
+		QueueMaxAttributeRescale(Rule->RescaledAttribute, Attribute, NewValue);
 	}
-	else if (Attribute == GetMaxStaminaAttribute())
+	else if (Rule->RescaledAttribute.IsValid())
 	{
-		AdjustAttributeForMaxChange(Stamina, MaxStamina, NewValue, GetStaminaAttribute());
+		AdjustAttributeForMaxChange(*Rule->RescaledAttribute.GetGameplayAttributeData(this), *Attribute.GetGameplayAttributeData(this), NewValue, Rule->RescaledAttribute);
 	}
-	else if (Attribute == GetMoveSpeedAttribute())
+
+	if (Rule->bClampPreChange)
 	{
-		// Cannot slow less than 150 units/s and cannot boost more than 1000 units/s
-		NewValue = FMath::Clamp<float>(NewValue, 150, 1000);
+		NewValue = FMath::Clamp<float>(NewValue, Rule->PreChangeMin, Rule->PreChangeMax);
 	}
 }
 
@@ -46,6 +157,42 @@ void UGDAttributeSetBase::PostGameplayEffectExecute(const FGameplayEffectModCall
 {
 	Super::PostGameplayEffectExecute(Data);
 
+	SCOPE_CYCLE_COUNTER(STAT_GDPostGameplayEffectExecute);
+	CSV_SCOPED_TIMING_STAT(GASDocumentation, PostGameplayEffectExecute);
+
+	UGDAbilitySystemComponent* OwningASC = Cast<UGDAbilitySystemComponent>(GetOwningAbilitySystemComponent());
+	if (OwningASC)
+	{
+		OwningASC->Telemetry.NumPostGameplayEffectExecutes++;
+	}
+	FGDCombatTelemetryScope TelemetryScope(OwningASC ? &OwningASC->Telemetry.PostGameplayEffectExecuteCycles : nullptr);
+
+	const FGDAttributeRule* Rule = FindAttributeRule(Data.EvaluatedData.Attribute);
+	if (!Rule)
+	{
+		return;
+	}
+
+	if (Rule->PostExecuteHandler)
+	{
+		(this->*Rule->PostExecuteHandler)(Data);
+	}
+
+	// Handle other changes to current values like Health, Mana and Stamina. Health loss should go through Damage.
+	// Inside a FGDScopedMaxAttributeRescale the max attribute's rescale hasn't been applied yet. Clamping now would clamp
+	// against the new max and then rescale the clamped value, so the clamp waits for the rescale at the end of the scope.
+	if (Rule->PostExecuteMaxAttribute.IsValid() && MaxAttributeRescaleScopeDepth > 0)
+	{
+		PendingMaxAttributeClamps.AddUnique(Data.EvaluatedData.Attribute);
+	}
+	else if (Rule->PostExecuteMaxAttribute.IsValid())
+	{
+		ClampToMaxAttribute(Data.EvaluatedData.Attribute, Rule->PostExecuteMaxAttribute);
+	}
+}
+
+void UGDAttributeSetBase::HandleDamageExecuted(const FGameplayEffectModCallbackData& Data)
+{
 	FGameplayEffectContextHandle Context = Data.EffectSpec.GetContext();
 	UAbilitySystemComponent* Source = Context.GetOriginalInstigatorAbilitySystemComponent();
 	const FGameplayTagContainer& SourceTags = *Data.EffectSpec.CapturedSourceTags.GetAggregatedTags();
@@ -96,126 +243,106 @@ void UGDAttributeSetBase::PostGameplayEffectExecute(const FGameplayEffectModCall
 		}
 	}
 
-	if (Data.EvaluatedData.Attribute == GetDamageAttribute())
+	// Store a local copy of the amount of damage done and clear the damage attribute
+	const float LocalDamageDone = GetDamage();
+	SetDamage(0.f);
+
+	if (LocalDamageDone > 0.0f)
 	{
-		// Try to extract a hit result
-		FHitResult HitResult;
-		if (Context.GetHitResult())
+		// If character was alive before damage is added, handle damage
+		// This prevents damage being added to dead things and replaying death animations
+		bool WasAlive = true;
+
+		if (TargetCharacter)
 		{
-			HitResult = *Context.GetHitResult();
+			WasAlive = TargetCharacter->IsAlive();
 		}
 
-		// Store a local copy of the amount of damage done and clear the damage attribute
-		const float LocalDamageDone = GetDamage();
-		SetDamage(0.f);
-	
-		if (LocalDamageDone > 0.0f)
+		if (!TargetCharacter->IsAlive())
 		{
-			// If character was alive before damage is added, handle damage
-			// This prevents damage being added to dead things and replaying death animations
-			bool WasAlive = true;
+			//UE_LOG(LogTemp, Warning, TEXT("%s() %s is NOT alive when receiving damage"), TEXT(__FUNCTION__), *TargetCharacter->GetName());
+		}
 
-			if (TargetCharacter)
-			{
-				WasAlive = TargetCharacter->IsAlive();
-			}
+		// Apply the health change and then clamp it
+		const FGDDamageOutcome Outcome = FGDCombatRules::ApplyDamage(GetHealth(), GetMaxHealth(), LocalDamageDone, SourceController == TargetController);
+		SetHealth(Outcome.NewHealth);
 
-			if (!TargetCharacter->IsAlive())
-			{
-				//UE_LOG(LogTemp, Warning, TEXT("%s() %s is NOT alive when receiving damage"), TEXT(__FUNCTION__), *TargetCharacter->GetName());
-			}
+		if (TargetCharacter && WasAlive)
+		{
+			// This is the log statement for damage received. Turned off for live games.
+			//UE_LOG(LogTemp, Log, TEXT("%s() %s Damage Received: %f"), TEXT(__FUNCTION__), *GetOwningActor()->GetName(), LocalDamageDone);
 
-			// Apply the health change and then clamp it
-			const float NewHealth = GetHealth() - LocalDamageDone;
-			SetHealth(FMath::Clamp(NewHealth, 0.0f, GetMaxHealth()));
+			// Play HitReact animation and sound with a multicast RPC.
+			const FHitResult* Hit = Context.GetHitResult();
+			EGDHitReactDirection HitDirection = EGDHitReactDirection::Front;
 
-			if (TargetCharacter && WasAlive)
+			if (Hit)
 			{
-				// This is the log statement for damage received. Turned off for live games.
-				//UE_LOG(LogTemp, Log, TEXT("%s() %s Damage Received: %f"), TEXT(__FUNCTION__), *GetOwningActor()->GetName(), LocalDamageDone);
-
-				// Play HitReact animation and sound with a multicast RPC.
-				const FHitResult* Hit = Data.EffectSpec.GetContext().GetHitResult();
+				HitDirection = TargetCharacter->GetHitReactDirection(Hit->Location);
 
-				if (Hit)
+				switch (HitDirection)
 				{
-					EGDHitReactDirection HitDirection = TargetCharacter->GetHitReactDirection(Data.EffectSpec.GetContext().GetHitResult()->Location);
-					switch (HitDirection)
-					{
-					case EGDHitReactDirection::Left:
-						TargetCharacter->PlayHitReact(HitDirectionLeftTag, SourceCharacter);
-						break;
-					case EGDHitReactDirection::Front:
-						TargetCharacter->PlayHitReact(HitDirectionFrontTag, SourceCharacter);
-						break;
-					case EGDHitReactDirection::Right:
-						TargetCharacter->PlayHitReact(HitDirectionRightTag, SourceCharacter);
-						break;
-					case EGDHitReactDirection::Back:
-						TargetCharacter->PlayHitReact(HitDirectionBackTag, SourceCharacter);
-						break;
-					}
-				}
-				else
-				{
-					// No hit result. Default to front.
+				case EGDHitReactDirection::Left:
+					TargetCharacter->PlayHitReact(HitDirectionLeftTag, SourceCharacter);
+					break;
+				case EGDHitReactDirection::Front:
 					TargetCharacter->PlayHitReact(HitDirectionFrontTag, SourceCharacter);
+					break;
+				case EGDHitReactDirection::Right:
+					TargetCharacter->PlayHitReact(HitDirectionRightTag, SourceCharacter);
+					break;
+				case EGDHitReactDirection::Back:
+					TargetCharacter->PlayHitReact(HitDirectionBackTag, SourceCharacter);
+					break;
 				}
+			}
+			else
+			{
+				// No hit result. Default to front.
+				TargetCharacter->PlayHitReact(HitDirectionFrontTag, SourceCharacter);
+			}
+
+			UGDCombatEventSubsystem::Record(EGDCombatEventType::HitReact, SourceCharacter, TargetCharacter, static_cast<float>(HitDirection));
 
-				// Show damage number for the Source player unless it was self damage
-				if (SourceActor != TargetActor)
+			// Show damage number for the Source player unless it was self damage
+			if (SourceActor != TargetActor)
+			{
+				AGDPlayerController* PC = Cast<AGDPlayerController>(SourceController);
+				if (PC)
 				{
-					AGDPlayerController* PC = Cast<AGDPlayerController>(SourceController);
-					if (PC)
-					{
-						PC->ShowDamageNumber(LocalDamageDone, TargetCharacter);
-					}
+					PC->ShowDamageNumber(LocalDamageDone, TargetCharacter);
 				}
+			}
 
-				if (!TargetCharacter->IsAlive())
+			if (Outcome.bKilled)
+			{
+				// TargetCharacter was alive before this damage and now is not alive, give XP and Gold bounties to Source.
+				// Don't give bounty to self.
+				if (Outcome.bAwardBounty)
 				{
-					// TargetCharacter was alive before this damage and now is not alive, give XP and Gold bounties to Source.
-					// Don't give bounty to self.
-					if (SourceController != TargetController)
-					{
-						// Create a dynamic instant Gameplay Effect to give the bounties
-						UGameplayEffect* GEBounty = NewObject<UGameplayEffect>(GetTransientPackage(), FName(TEXT("Bounty")));
-						GEBounty->DurationPolicy = EGameplayEffectDurationType::Instant;
-
-						int32 Idx = GEBounty->Modifiers.Num();
-						GEBounty->Modifiers.SetNum(Idx + 2);
-
-						FGameplayModifierInfo& InfoXP = GEBounty->Modifiers[Idx];
-						InfoXP.ModifierMagnitude = FScalableFloat(GetXPBounty());
-						InfoXP.ModifierOp = EGameplayModOp::Additive;
-						InfoXP.Attribute = UGDAttributeSetBase::GetXPAttribute();
-
-						FGameplayModifierInfo& InfoGold = GEBounty->Modifiers[Idx + 1];
-						InfoGold.ModifierMagnitude = FScalableFloat(GetGoldBounty());
-						InfoGold.ModifierOp = EGameplayModOp::Additive;
-						InfoGold.Attribute = UGDAttributeSetBase::GetGoldAttribute();
-
-						Source->ApplyGameplayEffectToSelf(GEBounty, 1.0f, Source->MakeEffectContext());
-					}
+					// Create a dynamic instant Gameplay Effect to give the bounties
+					UGameplayEffect* GEBounty = NewObject<UGameplayEffect>(GetTransientPackage(), FName(TEXT("Bounty")));
+					GEBounty->DurationPolicy = EGameplayEffectDurationType::Instant;
+
+					int32 Idx = GEBounty->Modifiers.Num();
+					GEBounty->Modifiers.SetNum(Idx + 2);
+
+					FGameplayModifierInfo& InfoXP = GEBounty->Modifiers[Idx];
+					InfoXP.ModifierMagnitude = FScalableFloat(GetXPBounty());
+					InfoXP.ModifierOp = EGameplayModOp::Additive;
+					InfoXP.Attribute = UGDAttributeSetBase::GetXPAttribute();
+
+					FGameplayModifierInfo& InfoGold = GEBounty->Modifiers[Idx + 1];
+					InfoGold.ModifierMagnitude = FScalableFloat(GetGoldBounty());
+					InfoGold.ModifierOp = EGameplayModOp::Additive;
+					InfoGold.Attribute = UGDAttributeSetBase::GetGoldAttribute();
+
+					Source->ApplyGameplayEffectToSelf(GEBounty, 1.0f, Source->MakeEffectContext());
+
+					UGDCombatEventSubsystem::Record(EGDCombatEventType::Bounty, SourceCharacter, TargetCharacter, GetXPBounty(), GetGoldBounty());
 				}
 			}
 		}
-	}// Damage
-	else if (Data.EvaluatedData.Attribute == GetHealthAttribute())
-	{
-		// Handle other health changes.
-		// Health loss should go through Damage.
-		SetHealth(FMath::Clamp(GetHealth(), 0.0f, GetMaxHealth()));
-	} // Health
-	else if (Data.EvaluatedData.Attribute == GetManaAttribute())
-	{
-		// Handle mana changes.
-		SetMana(FMath::Clamp(GetMana(), 0.0f, GetMaxMana()));
-	} // Mana
-	else if (Data.EvaluatedData.Attribute == GetStaminaAttribute())
-	{
-		// Handle stamina changes.
-		SetStamina(FMath::Clamp(GetStamina(), 0.0f, GetMaxStamina()));
 	}
 }
 
@@ -255,6 +382,83 @@ void UGDAttributeSetBase::AdjustAttributeForMaxChange(FGameplayAttributeData & A
 	}
 }
 
+void UGDAttributeSetBase::QueueMaxAttributeRescale(const FGameplayAttribute& AffectedAttribute, const FGameplayAttribute& MaxAttribute, float NewMaxValue)
+{
+	for (FGDPendingMaxAttributeRescale& PendingRescale : PendingMaxAttributeRescales)
+	{
+		if (PendingRescale.AffectedAttribute == AffectedAttribute)
+		{
+			PendingRescale.NewMaxValue = NewMaxValue;
+			return;
+		}
+	}
+
+	PendingMaxAttributeRescales.Add(FGDPendingMaxAttributeRescale{ AffectedAttribute, MaxAttribute.GetNumericValue(this), NewMaxValue });
+}
+
+void UGDAttributeSetBase::FlushMaxAttributeRescales()
+{
+	// Adjusting can change attributes, which must not queue into the array that is being iterated
+	TArray<FGDPendingMaxAttributeRescale, TInlineAllocator<3>> PendingRescales = MoveTemp(PendingMaxAttributeRescales);
+	PendingMaxAttributeRescales.Reset();
+
+	for (const FGDPendingMaxAttributeRescale& PendingRescale : PendingRescales)
+	{
+		FGameplayAttributeData* AffectedAttributeData = PendingRescale.AffectedAttribute.GetGameplayAttributeData(this);
+		if (AffectedAttributeData)
+		{
+			AdjustAttributeForMaxChange(*AffectedAttributeData, FGameplayAttributeData(PendingRescale.OldMaxValue), PendingRescale.NewMaxValue,
+				PendingRescale.AffectedAttribute);
+		}
+	}
+
+	// After the rescales so that a current value is clamped against the max it was rescaled to
+	TArray<FGameplayAttribute, TInlineAllocator<3>> PendingClamps = MoveTemp(PendingMaxAttributeClamps);
+	PendingMaxAttributeClamps.Reset();
+
+	for (const FGameplayAttribute& Attribute : PendingClamps)
+	{
+		const FGDAttributeRule* Rule = FindAttributeRule(Attribute);
+		if (Rule && Rule->PostExecuteMaxAttribute.IsValid())
+		{
+			ClampToMaxAttribute(Attribute, Rule->PostExecuteMaxAttribute);
+		}
+	}
+}
+
+void UGDAttributeSetBase::ClampToMaxAttribute(const FGameplayAttribute& Attribute, const FGameplayAttribute& MaxAttribute)
+{
+	const float Value = Attribute.GetNumericValue(this);
+	const float MaxValue = MaxAttribute.GetNumericValue(this);
+
+	UAbilitySystemComponent* AbilityComp = GetOwningAbilitySystemComponent();
+	if (ensure(AbilityComp))
+	{
+		AbilityComp->SetNumericAttributeBase(Attribute, FMath::Clamp(Value, 0.0f, MaxValue));
+	}
+}
+
+FGDScopedMaxAttributeRescale::FGDScopedMaxAttributeRescale(UAbilitySystemComponent* AbilitySystemComponent)
+{
+	if (AbilitySystemComponent)
+	{
+		AttributeSet = const_cast<UGDAttributeSetBase*>(AbilitySystemComponent->GetSet<UGDAttributeSetBase>());
+	}
+
+	if (AttributeSet.IsValid())
+	{
+		AttributeSet->MaxAttributeRescaleScopeDepth++;
+	}
+}
+
+FGDScopedMaxAttributeRescale::~FGDScopedMaxAttributeRescale()
+{
+	if (AttributeSet.IsValid() && --AttributeSet->MaxAttributeRescaleScopeDepth == 0)
+	{
+		AttributeSet->FlushMaxAttributeRescales();
+	}
+}
+
 void UGDAttributeSetBase::OnRep_Health()
 {
 	GAMEPLAYATTRIBUTE_REPNOTIFY(UGDAttributeSetBase, Health);
@@ -334,3 +538,9 @@ void UGDAttributeSetBase::OnRep_GoldBounty()
 {
 	GAMEPLAYATTRIBUTE_REPNOTIFY(UGDAttributeSetBase, GoldBounty);
 }
+
+const FGDAttributeRule* UGDAttributeSetBase::FindAttributeRule(const FGameplayAttribute& Attribute)
+{
+	static const FGDAttributeRuleTable RuleTable;
+	return RuleTable.Find(Attribute);
+}
@@ -2,8 +2,482 @@
 
 
 #include "GDAbilitySystemComponent.h"
+#include "AsyncTaskAttributeChanged.h"
+#include "AsyncTaskEffectStackChanged.h"
+#include "Engine/World.h"
+#include "GASDocumentation.h"
+#include "GDAttributeSetBase.h"
+#include "GDCombatEventSubsystem.h"
+#include "GDGameplayAbility.h"
+#include "GDRegenSubsystem.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectIterator.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Telemetry Abilities Activated"), STAT_GDTelemetryAbilitiesActivated, STATGROUP_GASDocumentation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Telemetry Effects Applied"), STAT_GDTelemetryEffectsApplied, STATGROUP_GASDocumentation);
+
+static FAutoConsoleCommandWithWorldAndArgs CVarGDTelemetryDump(
+	TEXT("GD.Telemetry.Dump"),
+	TEXT("Logs the characters that cost the most server time in PostGameplayEffectExecute, damage executions and Die(). Optional arg is the number of rows (default 10)."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UGDAbilitySystemComponent::DumpTelemetry(World, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10);
+	}));
+
+static FAutoConsoleCommandWithWorld CVarGDTelemetryReset(
+	TEXT("GD.Telemetry.Reset"),
+	TEXT("Resets the combat telemetry counters on every AbilitySystemComponent."),
+	FConsoleCommandWithWorldDelegate::CreateStatic(&UGDAbilitySystemComponent::ResetTelemetry));
 
 void UGDAbilitySystemComponent::ReceiveDamage(UGDAbilitySystemComponent * SourceASC, float UnmitigatedDamage, float MitigatedDamage)
 {
 	ReceivedDamage.Broadcast(SourceASC, UnmitigatedDamage, MitigatedDamage);
+
+	UGDCombatEventSubsystem::Record(EGDCombatEventType::Damage, SourceASC ? SourceASC->AvatarActor.Get() : nullptr, AvatarActor.Get(), MitigatedDamage, UnmitigatedDamage);
+}
+
+void UGDAbilitySystemComponent::AddAttributeChangeListener(const FGameplayAttribute& Attribute, UAsyncTaskAttributeChanged* Listener)
+{
+	if (!Attribute.IsValid() || !Listener)
+	{
+		return;
+	}
+
+	int32 Index = AttributeChangeListeners.IndexOfByPredicate([&Attribute](const FGDAttributeChangeListeners& Entry)
+	{
+		return Entry.Attribute == Attribute;
+	});
+
+	if (Index == INDEX_NONE)
+	{
+		Index = AttributeChangeListeners.AddDefaulted();
+		AttributeChangeListeners[Index].Attribute = Attribute;
+	}
+
+	FGDAttributeChangeListeners& Entry = AttributeChangeListeners[Index];
+	Entry.Listeners.AddUnique(Listener);
+
+	if (!Entry.DelegateHandle.IsValid())
+	{
+		Entry.DelegateHandle = GetGameplayAttributeValueChangeDelegate(Attribute).AddUObject(this, &UGDAbilitySystemComponent::NotifyAttributeChangeListeners, Index);
+	}
+}
+
+void UGDAbilitySystemComponent::RemoveAttributeChangeListener(UAsyncTaskAttributeChanged* Listener)
+{
+	for (FGDAttributeChangeListeners& Entry : AttributeChangeListeners)
+	{
+		const int32 ListenerIndex = Entry.Listeners.IndexOfByKey(Listener);
+		if (ListenerIndex != INDEX_NONE)
+		{
+			// Clear instead of remove so that an in progress notify loop doesn't skip anyone
+			Entry.Listeners[ListenerIndex] = nullptr;
+			Entry.bHasRemovedListeners = true;
+			CompactAttributeChangeListeners(Entry);
+		}
+	}
+}
+
+void UGDAbilitySystemComponent::NotifyAttributeChangeListeners(const FOnAttributeChangeData& Data, int32 AttributeChangeListenersIndex)
+{
+	AttributeChangeBroadcastDepth++;
+
+	// Index instead of reference because listeners can add Attributes and reallocate the array
+	for (int32 i = 0; i < AttributeChangeListeners[AttributeChangeListenersIndex].Listeners.Num(); i++)
+	{
+		UAsyncTaskAttributeChanged* Listener = AttributeChangeListeners[AttributeChangeListenersIndex].Listeners[i].Get();
+		if (Listener)
+		{
+			Listener->AttributeChanged(Data);
+		}
+		else
+		{
+			AttributeChangeListeners[AttributeChangeListenersIndex].bHasRemovedListeners = true;
+		}
+	}
+
+	AttributeChangeBroadcastDepth--;
+
+	CompactAttributeChangeListeners(AttributeChangeListeners[AttributeChangeListenersIndex]);
+}
+
+void UGDAbilitySystemComponent::CompactAttributeChangeListeners(FGDAttributeChangeListeners& Entry)
+{
+	if (AttributeChangeBroadcastDepth > 0 || !Entry.bHasRemovedListeners)
+	{
+		return;
+	}
+
+	Entry.Listeners.RemoveAll([](const TWeakObjectPtr<UAsyncTaskAttributeChanged>& Listener)
+	{
+		return !Listener.IsValid();
+	});
+
+	Entry.bHasRemovedListeners = false;
+
+	if (Entry.Listeners.Num() == 0 && Entry.DelegateHandle.IsValid())
+	{
+		GetGameplayAttributeValueChangeDelegate(Entry.Attribute).Remove(Entry.DelegateHandle);
+		Entry.DelegateHandle.Reset();
+	}
+}
+
+void UGDAbilitySystemComponent::AddEffectStackChangeListener(const FGameplayTag& EffectTag, UAsyncTaskEffectStackChanged* Listener)
+{
+	if (!EffectTag.IsValid() || !Listener)
+	{
+		return;
+	}
+
+	if (!EffectTagIndexAddedDelegateHandle.IsValid())
+	{
+		EffectTagIndexAddedDelegateHandle = OnActiveGameplayEffectAddedDelegateToSelf.AddUObject(this, &UGDAbilitySystemComponent::OnEffectTagIndexEffectAdded);
+		EffectTagIndexRemovedDelegateHandle = OnAnyGameplayEffectRemovedDelegate().AddUObject(this, &UGDAbilitySystemComponent::OnEffectTagIndexEffectRemoved);
+	}
+
+	FGDEffectTagIndexEntry* Entry = EffectTagIndex.Find(EffectTag);
+	if (!Entry)
+	{
+		EffectTagIndex.Add(EffectTag);
+
+		// Index the effects that were already active before anyone listened to this tag
+		for (const FActiveGameplayEffect& ActiveEffect : &ActiveGameplayEffects)
+		{
+			if (!ActiveEffect.IsPendingRemove)
+			{
+				IndexActiveEffect(ActiveEffect.Spec, ActiveEffect.Handle, ActiveEffect.Spec.StackCount);
+			}
+		}
+
+		Entry = EffectTagIndex.Find(EffectTag);
+	}
+
+	Entry->Listeners.AddUnique(Listener);
+}
+
+void UGDAbilitySystemComponent::RemoveEffectStackChangeListener(UAsyncTaskEffectStackChanged* Listener)
+{
+	for (auto EntryIt = EffectTagIndex.CreateIterator(); EntryIt; ++EntryIt)
+	{
+		FGDEffectTagIndexEntry& Entry = EntryIt.Value();
+		Entry.Listeners.Remove(Listener);
+		if (Entry.Listeners.Num() > 0)
+		{
+			continue;
+		}
+
+		// Stop indexing tags that nobody listens to
+		for (const FGDIndexedEffect& IndexedEffect : Entry.Effects)
+		{
+			TArray<FGameplayTag, TInlineAllocator<2>>* Tags = IndexedEffectTags.Find(IndexedEffect.Handle);
+			if (Tags)
+			{
+				Tags->Remove(EntryIt.Key());
+				if (Tags->Num() == 0)
+				{
+					IndexedEffectTags.Remove(IndexedEffect.Handle);
+				}
+			}
+		}
+
+		EntryIt.RemoveCurrent();
+	}
+
+	if (EffectTagIndex.Num() == 0 && EffectTagIndexAddedDelegateHandle.IsValid())
+	{
+		OnActiveGameplayEffectAddedDelegateToSelf.Remove(EffectTagIndexAddedDelegateHandle);
+		OnAnyGameplayEffectRemovedDelegate().Remove(EffectTagIndexRemovedDelegateHandle);
+		EffectTagIndexAddedDelegateHandle.Reset();
+		EffectTagIndexRemovedDelegateHandle.Reset();
+	}
+}
+
+int32 UGDAbilitySystemComponent::GetIndexedEffectStackCount(const FGameplayTag& EffectTag) const
+{
+	int32 StackCount = 0;
+
+	const FGDEffectTagIndexEntry* Entry = EffectTagIndex.Find(EffectTag);
+	if (Entry)
+	{
+		for (const FGDIndexedEffect& IndexedEffect : Entry->Effects)
+		{
+			StackCount += IndexedEffect.StackCount;
+		}
+	}
+
+	return StackCount;
+}
+
+void UGDAbilitySystemComponent::IndexActiveEffect(const FGameplayEffectSpec& Spec, FActiveGameplayEffectHandle ActiveHandle, int32 StackCount)
+{
+	if (!Spec.Def)
+	{
+		return;
+	}
+
+	// Same tags as FGameplayEffectSpec::GetAllAssetTags() and GetAllGrantedTags(), read in place instead of copied
+	bool bIndexed = false;
+	IndexTagsFromContainer(Spec.Def->InheritableGameplayEffectTags.CombinedTags, ActiveHandle, StackCount, bIndexed);
+	IndexTagsFromContainer(Spec.GetDynamicAssetTags(), ActiveHandle, StackCount, bIndexed);
+	IndexTagsFromContainer(Spec.Def->InheritableOwnedTagsContainer.CombinedTags, ActiveHandle, StackCount, bIndexed);
+	IndexTagsFromContainer(Spec.DynamicGrantedTags, ActiveHandle, StackCount, bIndexed);
+
+	if (bIndexed)
+	{
+		FOnActiveGameplayEffectStackChange* StackChangeDelegate = OnGameplayEffectStackChangeDelegate(ActiveHandle);
+		if (StackChangeDelegate)
+		{
+			// The handle may have been indexed before for a tag that nobody listens to anymore
+			StackChangeDelegate->RemoveAll(this);
+			StackChangeDelegate->AddUObject(this, &UGDAbilitySystemComponent::OnEffectTagIndexStackChanged);
+		}
+	}
+}
+
+void UGDAbilitySystemComponent::IndexTagsFromContainer(const FGameplayTagContainer& Tags, FActiveGameplayEffectHandle ActiveHandle, int32 StackCount, bool& bOutIndexed)
+{
+	for (const FGameplayTag& Tag : Tags)
+	{
+		FGDEffectTagIndexEntry* Entry = EffectTagIndex.Find(Tag);
+		if (!Entry)
+		{
+			continue;
+		}
+
+		TArray<FGameplayTag, TInlineAllocator<2>>& HandleTags = IndexedEffectTags.FindOrAdd(ActiveHandle);
+		if (HandleTags.Contains(Tag))
+		{
+			// Tag is both an Asset and a Granted tag
+			continue;
+		}
+
+		HandleTags.Add(Tag);
+		Entry->Effects.Add(FGDIndexedEffect{ ActiveHandle, StackCount });
+
+		// Only bind the stack change delegate once per handle
+		bOutIndexed = bOutIndexed || HandleTags.Num() == 1;
+	}
+}
+
+void UGDAbilitySystemComponent::OnEffectTagIndexEffectAdded(UAbilitySystemComponent* Target, const FGameplayEffectSpec& SpecApplied, FActiveGameplayEffectHandle ActiveHandle)
+{
+	const int32 StackCount = GetCurrentStackCount(ActiveHandle);
+	IndexActiveEffect(SpecApplied, ActiveHandle, StackCount);
+
+	TArray<FGameplayTag, TInlineAllocator<2>>* Tags = IndexedEffectTags.Find(ActiveHandle);
+	if (Tags)
+	{
+		// Copy because listeners can add or remove effects
+		TArray<FGameplayTag, TInlineAllocator<2>> TagsToNotify = *Tags;
+		for (const FGameplayTag& Tag : TagsToNotify)
+		{
+			NotifyEffectStackChangeListeners(Tag, ActiveHandle, StackCount, 0);
+		}
+	}
+}
+
+void UGDAbilitySystemComponent::OnEffectTagIndexEffectRemoved(const FActiveGameplayEffect& EffectRemoved)
+{
+	TArray<FGameplayTag, TInlineAllocator<2>> Tags;
+	if (!IndexedEffectTags.RemoveAndCopyValue(EffectRemoved.Handle, Tags))
+	{
+		return;
+	}
+
+	for (const FGameplayTag& Tag : Tags)
+	{
+		int32 PreviousStackCount = 0;
+
+		FGDEffectTagIndexEntry* Entry = EffectTagIndex.Find(Tag);
+		if (Entry)
+		{
+			const int32 Index = Entry->Effects.IndexOfByPredicate([&EffectRemoved](const FGDIndexedEffect& IndexedEffect)
+			{
+				return IndexedEffect.Handle == EffectRemoved.Handle;
+			});
+
+			if (Index != INDEX_NONE)
+			{
+				PreviousStackCount = Entry->Effects[Index].StackCount;
+				Entry->Effects.RemoveAtSwap(Index, 1, false);
+			}
+		}
+
+		NotifyEffectStackChangeListeners(Tag, EffectRemoved.Handle, 0, PreviousStackCount);
+	}
+}
+
+void UGDAbilitySystemComponent::OnEffectTagIndexStackChanged(FActiveGameplayEffectHandle EffectHandle, int32 NewStackCount, int32 PreviousStackCount)
+{
+	TArray<FGameplayTag, TInlineAllocator<2>>* Tags = IndexedEffectTags.Find(EffectHandle);
+	if (!Tags)
+	{
+		return;
+	}
+
+	TArray<FGameplayTag, TInlineAllocator<2>> TagsToNotify = *Tags;
+	for (const FGameplayTag& Tag : TagsToNotify)
+	{
+		FGDEffectTagIndexEntry* Entry = EffectTagIndex.Find(Tag);
+		if (Entry)
+		{
+			FGDIndexedEffect* IndexedEffect = Entry->Effects.FindByPredicate([&EffectHandle](const FGDIndexedEffect& Effect)
+			{
+				return Effect.Handle == EffectHandle;
+			});
+
+			if (IndexedEffect)
+			{
+				IndexedEffect->StackCount = NewStackCount;
+			}
+		}
+
+		NotifyEffectStackChangeListeners(Tag, EffectHandle, NewStackCount, PreviousStackCount);
+	}
+}
+
+void UGDAbilitySystemComponent::NotifyEffectStackChangeListeners(const FGameplayTag& EffectTag, FActiveGameplayEffectHandle EffectHandle, int32 NewStackCount, int32 PreviousStackCount)
+{
+	FGDEffectTagIndexEntry* Entry = EffectTagIndex.Find(EffectTag);
+	if (!Entry)
+	{
+		return;
+	}
+
+	// Copy because listeners can end their task while being notified. UI usually has one or two listeners per tag.
+	TArray<TWeakObjectPtr<UAsyncTaskEffectStackChanged>, TInlineAllocator<4>> Listeners = Entry->Listeners;
+	for (const TWeakObjectPtr<UAsyncTaskEffectStackChanged>& Listener : Listeners)
+	{
+		if (Listener.IsValid())
+		{
+			Listener->OnGameplayEffectStackChange.Broadcast(EffectTag, EffectHandle, NewStackCount, PreviousStackCount);
+		}
+	}
+}
+
+void UGDAbilitySystemComponent::DumpTelemetry(UWorld* World, int32 MaxRows)
+{
+	if (!World)
+	{
+		return;
+	}
+
+	TArray<UGDAbilitySystemComponent*> ASCs;
+	for (TObjectIterator<UGDAbilitySystemComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World && !It->IsPendingKill())
+		{
+			ASCs.Add(*It);
+		}
+	}
+
+	ASCs.Sort([](const UGDAbilitySystemComponent& A, const UGDAbilitySystemComponent& B)
+	{
+		return A.Telemetry.GetTotalCycles() > B.Telemetry.GetTotalCycles();
+	});
+
+	const UEnum* InputIDEnum = StaticEnum<EGDAbilityInputID>();
+	const double Now = FPlatformTime::Seconds();
+
+	UE_LOG(LogTemp, Log, TEXT("Combat telemetry for %d AbilitySystemComponents"), ASCs.Num());
+	UE_LOG(LogTemp, Log, TEXT("  %-32s %10s %10s %10s %10s %8s %8s %10s %8s"), TEXT("Avatar"), TEXT("Total ms"), TEXT("PostGE ms"), TEXT("Exec ms"), TEXT("Die ms"),
+		TEXT("PostGEs"), TEXT("Execs"), TEXT("GEs/s"), TEXT("Active"));
+
+	for (int32 Index = 0; Index < ASCs.Num() && Index < MaxRows; Index++)
+	{
+		const UGDAbilitySystemComponent* ASC = ASCs[Index];
+		const FGDCombatTelemetry& T = ASC->Telemetry;
+		const double Seconds = FMath::Max(Now - T.StartTime, KINDA_SMALL_NUMBER);
+
+		UE_LOG(LogTemp, Log, TEXT("  %-32s %10.3f %10.3f %10.3f %10.3f %8d %8d %10.2f %8d"), *GetNameSafe(ASC->AvatarActor.Get()),
+			FPlatformTime::ToMilliseconds64(T.GetTotalCycles()), FPlatformTime::ToMilliseconds64(T.PostGameplayEffectExecuteCycles),
+			FPlatformTime::ToMilliseconds64(T.DamageExecutionCycles), FPlatformTime::ToMilliseconds64(T.DieCycles),
+			T.NumPostGameplayEffectExecutes, T.NumDamageExecutions, T.NumEffectsApplied / Seconds, ASC->GetActiveGameplayEffects().GetNumGameplayEffects());
+
+		for (const TPair<uint8, int32>& Pair : T.AbilityActivationsByInputID)
+		{
+			UE_LOG(LogTemp, Log, TEXT("    %s activated %d times"), InputIDEnum ? *InputIDEnum->GetNameStringByValue(Pair.Key) : TEXT("?"), Pair.Value);
+		}
+	}
+}
+
+void UGDAbilitySystemComponent::ResetTelemetry(UWorld* World)
+{
+	const double Now = FPlatformTime::Seconds();
+	for (TObjectIterator<UGDAbilitySystemComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World)
+		{
+			It->Telemetry = FGDCombatTelemetry();
+			It->Telemetry.StartTime = Now;
+		}
+	}
+}
+
+FActiveGameplayEffectHandle UGDAbilitySystemComponent::ApplyGameplayEffectSpecToSelf(const FGameplayEffectSpec& GameplayEffect, FPredictionKey PredictionKey)
+{
+	FGDScopedMaxAttributeRescale RescaleScope(this);
+	return Super::ApplyGameplayEffectSpecToSelf(GameplayEffect, PredictionKey);
+}
+
+void UGDAbilitySystemComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Telemetry.StartTime = FPlatformTime::Seconds();
+	OnGameplayEffectAppliedDelegateToSelf.AddUObject(this, &UGDAbilitySystemComponent::OnTelemetryEffectApplied);
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		if (UGDRegenSubsystem* RegenSubsystem = UGDRegenSubsystem::Get(GetOwner()))
+		{
+			RegenSubsystem->RegisterAbilitySystemComponent(this);
+		}
+	}
+}
+
+void UGDAbilitySystemComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UGDRegenSubsystem* RegenSubsystem = UGDRegenSubsystem::Get(GetOwner()))
+	{
+		RegenSubsystem->UnregisterAbilitySystemComponent(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UGDAbilitySystemComponent::NotifyAbilityActivated(const FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability)
+{
+	Super::NotifyAbilityActivated(Handle, Ability);
+
+	const UGDGameplayAbility* GDAbility = Cast<UGDGameplayAbility>(Ability);
+	const uint8 InputID = static_cast<uint8>(GDAbility ? GDAbility->AbilityInputID : EGDAbilityInputID::None);
+
+	Telemetry.NumAbilitiesActivated++;
+	Telemetry.AbilityActivationsByInputID.FindOrAdd(InputID)++;
+	INC_DWORD_STAT(STAT_GDTelemetryAbilitiesActivated);
+
+#if CSV_PROFILER
+	static TArray<FName> CsvStatNames;
+	if (CsvStatNames.Num() == 0)
+	{
+		const UEnum* InputIDEnum = StaticEnum<EGDAbilityInputID>();
+		for (int32 Index = 0; InputIDEnum && Index < InputIDEnum->NumEnums() - 1; Index++)
+		{
+			CsvStatNames.Add(FName(*FString::Printf(TEXT("AbilityActivations_%s"), *InputIDEnum->GetNameStringByIndex(Index))));
+		}
+	}
+
+	if (CsvStatNames.IsValidIndex(InputID))
+	{
+		FCsvProfiler::RecordCustomStat(CsvStatNames[InputID], CSV_CATEGORY_INDEX(GASDocumentation), 1, ECsvCustomStatOp::Accumulate);
+	}
+#endif
+}
+
+void UGDAbilitySystemComponent::OnTelemetryEffectApplied(UAbilitySystemComponent* Target, const FGameplayEffectSpec& SpecApplied, FActiveGameplayEffectHandle ActiveHandle)
+{
+	Telemetry.NumEffectsApplied++;
+	INC_DWORD_STAT(STAT_GDTelemetryEffectsApplied);
+	CSV_CUSTOM_STAT(GASDocumentation, EffectsApplied, 1, ECsvCustomStatOp::Accumulate);
 }
@@ -0,0 +1,47 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDAbilitySystemGlobals.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GDGameplayEffectTypes.h"
+#include "HAL/IConsoleManager.h"
+
+static FAutoConsoleCommandWithWorld CVarGDEffectContextMeasure(
+	TEXT("GD.EffectContext.Measure"),
+	TEXT("Logs the bits a damage event's effect context (with a hit result) takes to replicate with the default and the compact effect context. Needs a network connection."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+		UNetConnection* Connection = NetDriver ? (NetDriver->ServerConnection ? NetDriver->ServerConnection : (NetDriver->ClientConnections.Num() > 0 ? NetDriver->ClientConnections[0] : nullptr)) : nullptr;
+		if (!Connection || !Connection->PackageMap)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("GD.EffectContext.Measure needs a client or a server with a connected client"));
+			return;
+		}
+
+		// Like a FireGun hit
+		FHitResult Hit;
+		Hit.bBlockingHit = true;
+		Hit.Location = Hit.ImpactPoint = FVector(1234.5f, -678.9f, 120.25f);
+		Hit.Normal = Hit.ImpactNormal = FVector(0.6f, -0.8f, 0.0f);
+		Hit.TraceStart = FVector(0.0f, 0.0f, 150.0f);
+		Hit.TraceEnd = FVector(5000.0f, -2750.0f, 100.0f);
+		Hit.Distance = 1400.0f;
+
+		FGDGameplayEffectContext Context;
+		Context.AddHitResult(Hit);
+
+		int64 BaseBits = 0;
+		int64 CompactBits = 0;
+		FGDGameplayEffectContext::MeasureNetSerialize(Context, Connection->PackageMap, BaseBits, CompactBits);
+
+		UE_LOG(LogTemp, Log, TEXT("Effect context per damage event: default %lld bits (%.1f bytes), compact %lld bits (%.1f bytes)"), BaseBits, BaseBits / 8.0,
+			CompactBits, CompactBits / 8.0);
+	}));
+
+FGameplayEffectContext* UGDAbilitySystemGlobals::AllocGameplayEffectContext() const
+{
+	return new FGDGameplayEffectContext();
+}
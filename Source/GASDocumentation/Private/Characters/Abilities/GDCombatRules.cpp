@@ -0,0 +1,161 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDCombatRules.h"
+#include "Async/ParallelFor.h"
+#include "GDDamageFormula.h"
+#include "Math/RandomStream.h"
+
+const float FGDCombatSimulator::MaxFightSeconds = 120.0f;
+
+float FGDCombatRules::MitigateDamage(const FGDDamageFormula* Formula, float UnmitigatedDamage, float Armor)
+{
+	if (Formula && Formula->IsValid())
+	{
+		float Variables[FGDDamageFormula::NumVariables];
+		Variables[FGDDamageFormula::Damage] = UnmitigatedDamage;
+		Variables[FGDDamageFormula::Armor] = Armor;
+
+		return Formula->Evaluate(Variables);
+	}
+
+	return MitigateDamageNative(UnmitigatedDamage, Armor);
+}
+
+float FGDCombatRules::MitigateDamageNative(float UnmitigatedDamage, float Armor)
+{
+	return (UnmitigatedDamage) * (100 / (100 + Armor));
+}
+
+FGDDamageOutcome FGDCombatRules::ApplyDamage(float Health, float MaxHealth, float Damage, bool bSelfInflicted)
+{
+	FGDDamageOutcome Outcome;
+	Outcome.bWasAlive = Health > 0.0f;
+	Outcome.NewHealth = FMath::Clamp(Health - Damage, 0.0f, MaxHealth);
+	Outcome.bKilled = Outcome.bWasAlive && Outcome.NewHealth <= 0.0f;
+	Outcome.bAwardBounty = Outcome.bKilled && !bSelfInflicted;
+	return Outcome;
+}
+
+void FGDCombatSimulationResult::Merge(const FGDCombatSimulationResult& Other)
+{
+	NumFights += Other.NumFights;
+	WinsA += Other.WinsA;
+	WinsB += Other.WinsB;
+	Draws += Other.Draws;
+	TotalFightSeconds += Other.TotalFightSeconds;
+	TotalWinnerHealthFraction += Other.TotalWinnerHealthFraction;
+	XPAwardedA += Other.XPAwardedA;
+	GoldAwardedA += Other.GoldAwardedA;
+	XPAwardedB += Other.XPAwardedB;
+	GoldAwardedB += Other.GoldAwardedB;
+}
+
+// Time between attacks, or never for combatants that don't attack
+static float GetAttackInterval(const FGDCombatantStats& Stats)
+{
+	return Stats.AttacksPerSecond > 0.0f ? 1.0f / Stats.AttacksPerSecond : MAX_flt;
+}
+
+static float RollDamage(const FGDCombatantStats& Stats, FRandomStream& RandomStream)
+{
+	return Stats.Damage * (1.0f + Stats.DamageVariance * RandomStream.FRandRange(-1.0f, 1.0f));
+}
+
+void FGDCombatSimulator::SimulateFight(const FGDCombatantStats& A, const FGDCombatantStats& B, const FGDDamageFormula* Formula, FRandomStream& RandomStream,
+	FGDCombatSimulationResult& InOutResult)
+{
+	InOutResult.NumFights++;
+
+	const float IntervalA = GetAttackInterval(A);
+	const float IntervalB = GetAttackInterval(B);
+
+	float HealthA = A.MaxHealth;
+	float HealthB = B.MaxHealth;
+
+	// Random first swing so that equal attack speeds don't always favor A
+	float NextAttackA = IntervalA < MAX_flt ? RandomStream.FRand() * IntervalA : MAX_flt;
+	float NextAttackB = IntervalB < MAX_flt ? RandomStream.FRand() * IntervalB : MAX_flt;
+
+	while (true)
+	{
+		const bool bAttackerIsA = NextAttackA <= NextAttackB;
+		const float Time = bAttackerIsA ? NextAttackA : NextAttackB;
+		if (Time > MaxFightSeconds)
+		{
+			InOutResult.Draws++;
+			return;
+		}
+
+		const FGDCombatantStats& Attacker = bAttackerIsA ? A : B;
+		const FGDCombatantStats& Defender = bAttackerIsA ? B : A;
+		float& DefenderHealth = bAttackerIsA ? HealthB : HealthA;
+
+		const float MitigatedDamage = FGDCombatRules::MitigateDamage(Formula, RollDamage(Attacker, RandomStream), Defender.Armor);
+		if (MitigatedDamage > 0.0f)
+		{
+			const FGDDamageOutcome Outcome = FGDCombatRules::ApplyDamage(DefenderHealth, Defender.MaxHealth, MitigatedDamage, false);
+			DefenderHealth = Outcome.NewHealth;
+
+			if (Outcome.bKilled)
+			{
+				const float AttackerHealth = bAttackerIsA ? HealthA : HealthB;
+				InOutResult.TotalFightSeconds += Time;
+				InOutResult.TotalWinnerHealthFraction += Attacker.MaxHealth > 0.0f ? AttackerHealth / Attacker.MaxHealth : 0.0f;
+
+				if (bAttackerIsA)
+				{
+					InOutResult.WinsA++;
+					InOutResult.XPAwardedA += Outcome.bAwardBounty ? B.XPBounty : 0.0f;
+					InOutResult.GoldAwardedA += Outcome.bAwardBounty ? B.GoldBounty : 0.0f;
+				}
+				else
+				{
+					InOutResult.WinsB++;
+					InOutResult.XPAwardedB += Outcome.bAwardBounty ? A.XPBounty : 0.0f;
+					InOutResult.GoldAwardedB += Outcome.bAwardBounty ? A.GoldBounty : 0.0f;
+				}
+
+				return;
+			}
+		}
+
+		if (bAttackerIsA)
+		{
+			NextAttackA += IntervalA;
+		}
+		else
+		{
+			NextAttackB += IntervalB;
+		}
+	}
+}
+
+FGDCombatSimulationResult FGDCombatSimulator::Run(const FGDCombatantStats& A, const FGDCombatantStats& B, const FGDDamageFormula* Formula, int32 NumFights, int32 Seed)
+{
+	const int32 NumChunks = FMath::DivideAndRoundUp(FMath::Max(NumFights, 0), FightsPerChunk);
+
+	TArray<FGDCombatSimulationResult> ChunkResults;
+	ChunkResults.SetNum(NumChunks);
+
+	ParallelFor(NumChunks, [&](int32 ChunkIndex)
+	{
+		FRandomStream RandomStream(Seed + ChunkIndex);
+		const int32 NumChunkFights = FMath::Min(FightsPerChunk, NumFights - ChunkIndex * FightsPerChunk);
+
+		FGDCombatSimulationResult& ChunkResult = ChunkResults[ChunkIndex];
+		for (int32 FightIndex = 0; FightIndex < NumChunkFights; FightIndex++)
+		{
+			SimulateFight(A, B, Formula, RandomStream, ChunkResult);
+		}
+	});
+
+	// Merged in chunk order so that the floating point sums don't depend on which thread finished first
+	FGDCombatSimulationResult Result;
+	for (const FGDCombatSimulationResult& ChunkResult : ChunkResults)
+	{
+		Result.Merge(ChunkResult);
+	}
+
+	return Result;
+}
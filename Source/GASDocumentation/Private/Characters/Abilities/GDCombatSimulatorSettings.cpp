@@ -0,0 +1,77 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDCombatSimulatorSettings.h"
+#include "GDDamageExecCalculation.h"
+#include "HAL/IConsoleManager.h"
+
+static FAutoConsoleCommandWithArgs CVarGDCombatSimRun(
+	TEXT("GD.CombatSim.Run"),
+	TEXT("Simulates fights between two combat profiles from DefaultGame.ini. Args are ProfileA ProfileB [NumFights (default 1000000)] [Seed (default 0)]."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() < 2)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("GD.CombatSim.Run needs two profile names"));
+			return;
+		}
+
+		const int32 NumFights = Args.Num() > 2 ? FCString::Atoi(*Args[2]) : 1000000;
+		const int32 Seed = Args.Num() > 3 ? FCString::Atoi(*Args[3]) : 0;
+		UGDCombatSimulatorSettings::RunSimulation(FName(*Args[0]), FName(*Args[1]), NumFights, Seed);
+	}));
+
+static FAutoConsoleCommand CVarGDCombatSimReload(
+	TEXT("GD.CombatSim.Reload"),
+	TEXT("Reloads the combat simulator profiles from config. Use GD.DamageFormula.Reload for the MitigationFormula."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		GetMutableDefault<UGDCombatSimulatorSettings>()->ReloadConfig();
+	}));
+
+FGDCombatantStats FGDCombatProfile::ToCombatantStats() const
+{
+	FGDCombatantStats Stats;
+	Stats.MaxHealth = MaxHealth;
+	Stats.Armor = Armor;
+	Stats.Damage = Damage;
+	Stats.DamageVariance = DamageVariance;
+	Stats.AttacksPerSecond = AttacksPerSecond;
+	Stats.XPBounty = XPBounty;
+	Stats.GoldBounty = GoldBounty;
+	return Stats;
+}
+
+const FGDCombatProfile* UGDCombatSimulatorSettings::FindProfile(FName Name) const
+{
+	return Profiles.FindByPredicate([Name](const FGDCombatProfile& Profile) { return Profile.Name == Name; });
+}
+
+void UGDCombatSimulatorSettings::RunSimulation(FName ProfileA, FName ProfileB, int32 NumFights, int32 Seed)
+{
+	const UGDCombatSimulatorSettings* Settings = GetDefault<UGDCombatSimulatorSettings>();
+	const FGDCombatProfile* A = Settings->FindProfile(ProfileA);
+	const FGDCombatProfile* B = Settings->FindProfile(ProfileB);
+	if (!A || !B)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s() Couldn't find combat profile %s in DefaultGame.ini"), TEXT(__FUNCTION__), *(A ? ProfileB : ProfileA).ToString());
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const FGDCombatSimulationResult Result = FGDCombatSimulator::Run(A->ToCombatantStats(), B->ToCombatantStats(), &UGDDamageExecCalculation::GetMitigationFormula(),
+		FMath::Max(NumFights, 1), Seed);
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	const int32 NumDecided = Result.WinsA + Result.WinsB;
+	const double Fights = FMath::Max(Result.NumFights, 1);
+
+	UE_LOG(LogTemp, Log, TEXT("Combat simulation %s vs %s: %d fights in %.1f ms (%.2f million fights/s)"), *ProfileA.ToString(), *ProfileB.ToString(), Result.NumFights,
+		Seconds * 1000.0, Seconds > 0.0 ? Result.NumFights / Seconds / 1000000.0 : 0.0);
+	UE_LOG(LogTemp, Log, TEXT("  %s wins %.2f%%, %s wins %.2f%%, draws %.2f%%"), *ProfileA.ToString(), Result.WinsA * 100.0 / Fights, *ProfileB.ToString(),
+		Result.WinsB * 100.0 / Fights, Result.Draws * 100.0 / Fights);
+	UE_LOG(LogTemp, Log, TEXT("  Average time to kill %.2f s, winner health left %.1f%%"), NumDecided > 0 ? Result.TotalFightSeconds / NumDecided : 0.0,
+		NumDecided > 0 ? Result.TotalWinnerHealthFraction * 100.0 / NumDecided : 0.0);
+	UE_LOG(LogTemp, Log, TEXT("  Average bounty per fight: %s %.1f XP %.1f Gold, %s %.1f XP %.1f Gold"), *ProfileA.ToString(), Result.XPAwardedA / Fights,
+		Result.GoldAwardedA / Fights, *ProfileB.ToString(), Result.XPAwardedB / Fights, Result.GoldAwardedB / Fights);
+}
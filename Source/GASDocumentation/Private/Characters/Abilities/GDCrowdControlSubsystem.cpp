@@ -0,0 +1,120 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDCrowdControlSubsystem.h"
+#include "AbilitySystemComponent.h"
+#include "Engine/GameInstance.h"
+#include "GameplayTagContainer.h"
+#include "GASDocumentation.h"
+#include "GDCharacterBase.h"
+
+DECLARE_CYCLE_STAT(TEXT("CrowdControl Resolve"), STAT_GDCrowdControlResolve, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("CrowdControl Deaths Queued"), STAT_GDCrowdControlQueued, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("CrowdControl Deaths Resolved"), STAT_GDCrowdControlResolved, STATGROUP_GASDocumentation);
+
+struct FGDCrowdControlTags
+{
+	FGameplayTagContainer StunAbilityTagsToCancel;
+	FGameplayTagContainer StunAbilityTagsToIgnore;
+	FGameplayTag DeadTag;
+
+	FGDCrowdControlTags()
+	{
+		StunAbilityTagsToCancel.AddTag(FGameplayTag::RequestGameplayTag(FName("Ability")));
+		StunAbilityTagsToIgnore.AddTag(FGameplayTag::RequestGameplayTag(FName("Ability.NotCanceledByStun")));
+		DeadTag = FGameplayTag::RequestGameplayTag(FName("State.Dead"));
+	}
+};
+
+static const FGDCrowdControlTags& GetCrowdControlTags()
+{
+	// Built on first use so that the tags are requested after the tag manager has loaded them
+	static const FGDCrowdControlTags Tags;
+	return Tags;
+}
+
+UGDCrowdControlSubsystem* UGDCrowdControlSubsystem::Get(const AActor* Actor)
+{
+	UGameInstance* GameInstance = Actor ? Actor->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UGDCrowdControlSubsystem>() : nullptr;
+}
+
+void UGDCrowdControlSubsystem::ApplyStun(UAbilitySystemComponent* AbilitySystemComponent)
+{
+	if (AbilitySystemComponent)
+	{
+		const FGDCrowdControlTags& Tags = GetCrowdControlTags();
+		AbilitySystemComponent->CancelAbilities(&Tags.StunAbilityTagsToCancel, &Tags.StunAbilityTagsToIgnore);
+	}
+}
+
+void UGDCrowdControlSubsystem::ApplyDeath(UAbilitySystemComponent* AbilitySystemComponent)
+{
+	if (AbilitySystemComponent)
+	{
+		AbilitySystemComponent->CancelAllAbilities();
+		AbilitySystemComponent->AddLooseGameplayTag(GetCrowdControlTags().DeadTag);
+	}
+}
+
+void UGDCrowdControlSubsystem::QueueDeath(AGDCharacterBase* Character)
+{
+	if (Character)
+	{
+		INC_DWORD_STAT(STAT_GDCrowdControlQueued);
+		PendingDeaths.Add(Character);
+	}
+}
+
+void UGDCrowdControlSubsystem::ResolvePendingDeaths()
+{
+	SCOPE_CYCLE_COUNTER(STAT_GDCrowdControlResolve);
+
+	// Resolving can queue new deaths (e.g. Die() removing effects). Those wait for the next frame.
+	TArray<TWeakObjectPtr<AGDCharacterBase>> DeathsToResolve = MoveTemp(PendingDeaths);
+	PendingDeaths.Reset();
+
+	for (const TWeakObjectPtr<AGDCharacterBase>& PendingDeath : DeathsToResolve)
+	{
+		// The Character is already gated by ApplyDeath(), so Die() runs even if it was healed since
+		AGDCharacterBase* Character = PendingDeath.Get();
+		if (Character)
+		{
+			Character->Die();
+			INC_DWORD_STAT(STAT_GDCrowdControlResolved);
+		}
+	}
+}
+
+int32 UGDCrowdControlSubsystem::GetNumPendingDeaths() const
+{
+	return PendingDeaths.Num();
+}
+
+void UGDCrowdControlSubsystem::Deinitialize()
+{
+	PendingDeaths.Empty();
+
+	Super::Deinitialize();
+}
+
+void UGDCrowdControlSubsystem::Tick(float DeltaTime)
+{
+	ResolvePendingDeaths();
+}
+
+bool UGDCrowdControlSubsystem::IsTickable() const
+{
+	return !HasAnyFlags(RF_ClassDefaultObject) && PendingDeaths.Num() > 0;
+}
+
+TStatId UGDCrowdControlSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGDCrowdControlSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UGDCrowdControlSubsystem::GetTickableGameObjectWorld() const
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	return GameInstance ? GameInstance->GetWorld() : nullptr;
+}
@@ -3,7 +3,41 @@
 
 #include "GDDamageExecCalculation.h"
 #include "GDAbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "Engine/GameInstance.h"
+#include "GASDocumentation.h"
 #include "GDAttributeSetBase.h"
+#include "GDCombatRules.h"
+#include "GDDamageFormula.h"
+#include "GDMassMinionCharacter.h"
+#include "GDMassMinionSubsystem.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("DamageExec Execute"), STAT_GDDamageExecExecute, STATGROUP_GASDocumentation);
+DECLARE_CYCLE_STAT(TEXT("DamageBatch Gather"), STAT_GDDamageBatchGather, STATGROUP_GASDocumentation);
+DECLARE_CYCLE_STAT(TEXT("DamageBatch Commit"), STAT_GDDamageBatchCommit, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("DamageBatch Entries"), STAT_GDDamageBatchEntries, STATGROUP_GASDocumentation);
+
+static FAutoConsoleCommand CVarGDDamageFormulaReload(
+	TEXT("GD.DamageFormula.Reload"),
+	TEXT("Reloads the damage exec calc's config and recompiles its MitigationFormula."),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		GetMutableDefault<UGDDamageExecCalculation>()->ReloadConfig();
+		UGDDamageExecCalculation::CompileMitigationFormula();
+	}));
+
+static FAutoConsoleCommandWithArgs CVarGDDamageFormulaBenchmark(
+	TEXT("GD.DamageFormula.Benchmark"),
+	TEXT("Times the compiled MitigationFormula against the hand written C++ formula. Optional argument is the number of samples (default 1000000)."),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumSamples = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000000;
+		UGDDamageExecCalculation::RunFormulaBenchmark(FMath::Max(NumSamples, 1));
+	}));
+
+// Compiled from the CDO's MitigationFormula. Only written on the game thread while no damage batch is running.
+static FGDDamageFormula CompiledMitigationFormula;
 
 // Declare the attributes to capture and define how we want to capture them from the Source and Target.
 struct GDDamageStatics
@@ -25,7 +59,12 @@ struct GDDamageStatics
 
 		// The Target's received Damage. This is the value of health that will be subtracted on the Target. We're not capturing this.
 		DEFINE_ATTRIBUTE_CAPTUREDEF(UGDAttributeSetBase, Damage, Target, false);
+
+		DamageTag = FGameplayTag::RequestGameplayTag(FName("Data.Damage"));
 	}
+
+	// SetByCaller unmitigated damage
+	FGameplayTag DamageTag;
 };
 
 static const GDDamageStatics& DamageStatics()
@@ -46,6 +85,16 @@ void UGDDamageExecCalculation::Execute_Implementation(const FGameplayEffectCusto
 	UAbilitySystemComponent* TargetAbilitySystemComponent = ExecutionParams.GetTargetAbilitySystemComponent();
 	UAbilitySystemComponent* SourceAbilitySystemComponent = ExecutionParams.GetSourceAbilitySystemComponent();
 
+	SCOPE_CYCLE_COUNTER(STAT_GDDamageExecExecute);
+	CSV_SCOPED_TIMING_STAT(GASDocumentation, DamageExecution);
+
+	UGDAbilitySystemComponent* TargetGDASC = Cast<UGDAbilitySystemComponent>(TargetAbilitySystemComponent);
+	if (TargetGDASC)
+	{
+		TargetGDASC->Telemetry.NumDamageExecutions++;
+	}
+	FGDCombatTelemetryScope TelemetryScope(TargetGDASC ? &TargetGDASC->Telemetry.DamageExecutionCycles : nullptr);
+
 	AActor* SourceActor = SourceAbilitySystemComponent ? SourceAbilitySystemComponent->AvatarActor : nullptr;
 	AActor* TargetActor = TargetAbilitySystemComponent ? TargetAbilitySystemComponent->AvatarActor : nullptr;
 
@@ -55,6 +104,11 @@ void UGDDamageExecCalculation::Execute_Implementation(const FGameplayEffectCusto
 	const FGameplayTagContainer* SourceTags = Spec.CapturedSourceTags.GetAggregatedTags();
 	const FGameplayTagContainer* TargetTags = Spec.CapturedTargetTags.GetAggregatedTags();
 
+	// SetByCaller Damage
+	float Damage = FMath::Max<float>(Spec.GetSetByCallerMagnitude(DamageStatics().DamageTag, false, -1.0f), 0.0f);
+
+	float UnmitigatedDamage = Damage; // Can multiply any damage boosters here
+
 	FAggregatorEvaluateParameters EvaluationParameters;
 	EvaluationParameters.SourceTags = SourceTags;
 	EvaluationParameters.TargetTags = TargetTags;
@@ -62,12 +116,7 @@ void UGDDamageExecCalculation::Execute_Implementation(const FGameplayEffectCusto
 	float Armor = 0.0f;
 	FMath::Max<float>(ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().ArmorDef, EvaluationParameters, Armor), 0.0f);
 
-	// SetByCaller Damage
-	float Damage = FMath::Max<float>(Spec.GetSetByCallerMagnitude(FGameplayTag::RequestGameplayTag(FName("Data.Damage")), false, -1.0f), 0.0f);
-
-	float UnmitigatedDamage = Damage; // Can multiply any damage boosters here
-	
-	float MitigatedDamage = (UnmitigatedDamage) * (100 / (100 + Armor));
+	const float MitigatedDamage = CalculateMitigatedDamage(UnmitigatedDamage, Armor);
 
 	if (MitigatedDamage > 0.f)
 	{
@@ -83,3 +132,176 @@ void UGDDamageExecCalculation::Execute_Implementation(const FGameplayEffectCusto
 		TargetASC->ReceiveDamage(SourceASC, UnmitigatedDamage, MitigatedDamage);
 	}
 }
+
+float UGDDamageExecCalculation::CalculateMitigatedDamage(float UnmitigatedDamage, float Armor)
+{
+	return FGDCombatRules::MitigateDamage(&CompiledMitigationFormula, UnmitigatedDamage, Armor);
+}
+
+const FGDDamageFormula& UGDDamageExecCalculation::GetMitigationFormula()
+{
+	return CompiledMitigationFormula;
+}
+
+void UGDDamageExecCalculation::CompileMitigationFormula()
+{
+	const FString& Formula = GetDefault<UGDDamageExecCalculation>()->MitigationFormula;
+	if (Formula.IsEmpty())
+	{
+		CompiledMitigationFormula = FGDDamageFormula();
+		return;
+	}
+
+	FString Error;
+	if (!CompiledMitigationFormula.Compile(Formula, Error))
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s() Couldn't compile MitigationFormula \"%s\": %s. Using the built in formula."), TEXT(__FUNCTION__), *Formula, *Error);
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("%s() Compiled MitigationFormula \"%s\" to %d instructions"), TEXT(__FUNCTION__), *Formula, CompiledMitigationFormula.GetNumInstructions());
+}
+
+void UGDDamageExecCalculation::RunFormulaBenchmark(int32 NumSamples)
+{
+	if (!CompiledMitigationFormula.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s() No compiled MitigationFormula to benchmark"), TEXT(__FUNCTION__));
+		return;
+	}
+
+	// Same inputs for both so that the results can be compared
+	FRandomStream RandomStream(1234);
+	TArray<float> Damages;
+	TArray<float> Armors;
+	TArray<float> NativeResults;
+	TArray<float> CompiledResults;
+	Damages.SetNumUninitialized(NumSamples);
+	Armors.SetNumUninitialized(NumSamples);
+	NativeResults.SetNumUninitialized(NumSamples);
+	CompiledResults.SetNumUninitialized(NumSamples);
+
+	for (int32 Index = 0; Index < NumSamples; Index++)
+	{
+		Damages[Index] = RandomStream.FRandRange(0.0f, 200.0f);
+		Armors[Index] = RandomStream.FRandRange(0.0f, 100.0f);
+	}
+
+	const double NativeStartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumSamples; Index++)
+	{
+		NativeResults[Index] = FGDCombatRules::MitigateDamageNative(Damages[Index], Armors[Index]);
+	}
+	const double NativeSeconds = FPlatformTime::Seconds() - NativeStartTime;
+
+	const double CompiledStartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumSamples; Index++)
+	{
+		CompiledResults[Index] = CalculateMitigatedDamage(Damages[Index], Armors[Index]);
+	}
+	const double CompiledSeconds = FPlatformTime::Seconds() - CompiledStartTime;
+
+	float MaxDifference = 0.0f;
+	for (int32 Index = 0; Index < NumSamples; Index++)
+	{
+		MaxDifference = FMath::Max(MaxDifference, FMath::Abs(NativeResults[Index] - CompiledResults[Index]));
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("%s() %d samples: native %.3f ms, compiled %.3f ms (%.2fx), max difference from the native formula %f"), TEXT(__FUNCTION__), NumSamples,
+		NativeSeconds * 1000.0, CompiledSeconds * 1000.0, NativeSeconds > 0.0 ? CompiledSeconds / NativeSeconds : 0.0, MaxDifference);
+}
+
+void UGDDamageExecCalculation::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// Config has been loaded into the CDO by now
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		CompileMitigationFormula();
+	}
+}
+
+void UGDDamageExecCalculation::ApplyDamageBatch(const TArray<FGDDamageBatchEntry>& Entries)
+{
+	const int32 NumEntries = Entries.Num();
+	if (NumEntries == 0)
+	{
+		return;
+	}
+
+	INC_DWORD_STAT_BY(STAT_GDDamageBatchEntries, NumEntries);
+
+	TArray<UAbilitySystemComponent*> TargetASCs;
+	TArray<AGDMassMinionCharacter*> TargetMassMinions;
+	TArray<float> UnmitigatedDamages;
+	TArray<float> Armors;
+	TargetASCs.SetNumZeroed(NumEntries);
+	TargetMassMinions.SetNumZeroed(NumEntries);
+	UnmitigatedDamages.SetNumZeroed(NumEntries);
+	Armors.SetNumZeroed(NumEntries);
+
+	UGDMassMinionSubsystem* MassMinionSubsystem = nullptr;
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_GDDamageBatchGather);
+
+		for (int32 Index = 0; Index < NumEntries; Index++)
+		{
+			const FGDDamageBatchEntry& Entry = Entries[Index];
+			AActor* TargetActor = Entry.TargetActor.Get();
+			if (!Entry.SpecHandle.IsValid() || !TargetActor || TargetActor->Role != ROLE_Authority)
+			{
+				continue;
+			}
+
+			// Targets with an ASC go through the exec calc, which mitigates against the captured, tag qualified Armor.
+			// That also keeps duration and periodic effects evaluating the current Armor on every execution.
+			UAbilitySystemComponent* TargetASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(TargetActor);
+			if (TargetASC)
+			{
+				TargetASCs[Index] = TargetASC;
+				continue;
+			}
+
+			AGDMassMinionCharacter* MassMinion = Cast<AGDMassMinionCharacter>(TargetActor);
+			if (MassMinion)
+			{
+				if (!MassMinionSubsystem)
+				{
+					UGameInstance* GameInstance = TargetActor->GetGameInstance();
+					MassMinionSubsystem = GameInstance ? GameInstance->GetSubsystem<UGDMassMinionSubsystem>() : nullptr;
+				}
+
+				const int32 MassMinionIndex = MassMinion->GetMassMinionIndex();
+				if (MassMinionSubsystem && MassMinionSubsystem->GetAttributeTable().IsValidIndex(MassMinionIndex)
+					&& MassMinionSubsystem->IsSupportedEffectSpec(*Entry.SpecHandle.Data.Get()))
+				{
+					TargetMassMinions[Index] = MassMinion;
+					UnmitigatedDamages[Index] = FMath::Max<float>(Entry.SpecHandle.Data->GetSetByCallerMagnitude(DamageStatics().DamageTag, false, -1.0f), 0.0f);
+					Armors[Index] = FMath::Max<float>(MassMinionSubsystem->GetAttributeTable().Armor[MassMinionIndex], 0.0f);
+				}
+			}
+		}
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_GDDamageBatchCommit);
+
+		// In the order of Entries so that kills and bounties resolve deterministically
+		for (int32 Index = 0; Index < NumEntries; Index++)
+		{
+			const FGameplayEffectSpec& Spec = *Entries[Index].SpecHandle.Data.Get();
+
+			if (TargetASCs[Index])
+			{
+				TargetASCs[Index]->ApplyGameplayEffectSpecToSelf(Spec);
+			}
+			else if (TargetMassMinions[Index] && MassMinionSubsystem)
+			{
+				MassMinionSubsystem->ApplyMitigatedDamage(TargetMassMinions[Index]->GetMassMinionIndex(), Spec,
+					CalculateMitigatedDamage(UnmitigatedDamages[Index], Armors[Index]));
+			}
+		}
+	}
+}
@@ -0,0 +1,309 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDDamageFormula.h"
+
+// Recursive descent parser that emits postfix instructions as it goes
+class FGDDamageFormulaParser
+{
+public:
+	FGDDamageFormulaParser(const FString& InExpression, TArray<FGDDamageFormula::FInstruction>& InInstructions)
+		: Expression(InExpression), Position(0), Instructions(InInstructions), StackDepth(0)
+	{
+	}
+
+	bool Parse(FString& OutError)
+	{
+		if (!ParseExpression())
+		{
+			OutError = Error;
+			return false;
+		}
+
+		SkipWhitespace();
+		if (Position < Expression.Len())
+		{
+			OutError = FString::Printf(TEXT("Unexpected '%c' at %d"), Expression[Position], Position);
+			return false;
+		}
+
+		return true;
+	}
+
+private:
+	const FString& Expression;
+	int32 Position;
+	TArray<FGDDamageFormula::FInstruction>& Instructions;
+	int32 StackDepth;
+	FString Error;
+
+	typedef FGDDamageFormula::EOp EOp;
+
+	void SkipWhitespace()
+	{
+		while (Position < Expression.Len() && FChar::IsWhitespace(Expression[Position]))
+		{
+			Position++;
+		}
+	}
+
+	bool Match(TCHAR Character)
+	{
+		SkipWhitespace();
+		if (Position < Expression.Len() && Expression[Position] == Character)
+		{
+			Position++;
+			return true;
+		}
+
+		return false;
+	}
+
+	bool Fail(const TCHAR* Message)
+	{
+		if (Error.IsEmpty())
+		{
+			Error = FString::Printf(TEXT("%s at %d"), Message, Position);
+		}
+
+		return false;
+	}
+
+	bool Emit(EOp Op, uint8 VariableIndex = 0, float Constant = 0.0f)
+	{
+		// Track the stack depth the instructions will need so that Evaluate() never overflows
+		switch (Op)
+		{
+		case EOp::Constant:
+		case EOp::Variable:
+			StackDepth++;
+			break;
+		case EOp::Negate:
+			break;
+		default:
+			StackDepth--;
+			break;
+		}
+
+		if (StackDepth > FGDDamageFormula::MaxStackDepth)
+		{
+			return Fail(TEXT("Formula is nested too deeply"));
+		}
+
+		Instructions.Add(FGDDamageFormula::FInstruction{ Op, VariableIndex, Constant });
+		return true;
+	}
+
+	// Expression := Term (('+' | '-') Term)*
+	bool ParseExpression()
+	{
+		if (!ParseTerm())
+		{
+			return false;
+		}
+
+		while (true)
+		{
+			if (Match(TEXT('+')))
+			{
+				if (!ParseTerm() || !Emit(EOp::Add))
+				{
+					return false;
+				}
+			}
+			else if (Match(TEXT('-')))
+			{
+				if (!ParseTerm() || !Emit(EOp::Subtract))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				return true;
+			}
+		}
+	}
+
+	// Term := Unary (('*' | '/') Unary)*
+	bool ParseTerm()
+	{
+		if (!ParseUnary())
+		{
+			return false;
+		}
+
+		while (true)
+		{
+			if (Match(TEXT('*')))
+			{
+				if (!ParseUnary() || !Emit(EOp::Multiply))
+				{
+					return false;
+				}
+			}
+			else if (Match(TEXT('/')))
+			{
+				if (!ParseUnary() || !Emit(EOp::Divide))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				return true;
+			}
+		}
+	}
+
+	// Unary := '-' Unary | Primary
+	bool ParseUnary()
+	{
+		if (Match(TEXT('-')))
+		{
+			return ParseUnary() && Emit(EOp::Negate);
+		}
+
+		return ParsePrimary();
+	}
+
+	// Primary := Number | Variable | Function '(' Expression ',' Expression ')' | '(' Expression ')'
+	bool ParsePrimary()
+	{
+		SkipWhitespace();
+		if (Position >= Expression.Len())
+		{
+			return Fail(TEXT("Unexpected end of formula"));
+		}
+
+		if (Match(TEXT('(')))
+		{
+			if (!ParseExpression())
+			{
+				return false;
+			}
+
+			return Match(TEXT(')')) || Fail(TEXT("Expected ')'"));
+		}
+
+		const TCHAR Character = Expression[Position];
+		if (FChar::IsDigit(Character) || Character == TEXT('.'))
+		{
+			const int32 Start = Position;
+			while (Position < Expression.Len() && (FChar::IsDigit(Expression[Position]) || Expression[Position] == TEXT('.')))
+			{
+				Position++;
+			}
+
+			return Emit(EOp::Constant, 0, FCString::Atof(*Expression.Mid(Start, Position - Start)));
+		}
+
+		if (FChar::IsAlpha(Character))
+		{
+			const int32 Start = Position;
+			while (Position < Expression.Len() && FChar::IsAlnum(Expression[Position]))
+			{
+				Position++;
+			}
+
+			const FString Identifier = Expression.Mid(Start, Position - Start);
+
+			if (Identifier == TEXT("Damage"))
+			{
+				return Emit(EOp::Variable, FGDDamageFormula::Damage);
+			}
+
+			if (Identifier == TEXT("Armor"))
+			{
+				return Emit(EOp::Variable, FGDDamageFormula::Armor);
+			}
+
+			if (Identifier == TEXT("min") || Identifier == TEXT("max"))
+			{
+				if (!Match(TEXT('(')) || !ParseExpression() || !Match(TEXT(',')) || !ParseExpression() || !Match(TEXT(')')))
+				{
+					return Fail(TEXT("Expected min(a, b) or max(a, b)"));
+				}
+
+				return Emit(Identifier == TEXT("min") ? EOp::Min : EOp::Max);
+			}
+
+			Position = Start;
+			return Fail(TEXT("Unknown variable"));
+		}
+
+		return Fail(TEXT("Unexpected character"));
+	}
+};
+
+bool FGDDamageFormula::Compile(const FString& Expression, FString& OutError)
+{
+	Instructions.Reset();
+
+	FGDDamageFormulaParser Parser(Expression, Instructions);
+	if (!Parser.Parse(OutError))
+	{
+		Instructions.Reset();
+		return false;
+	}
+
+	return true;
+}
+
+bool FGDDamageFormula::IsValid() const
+{
+	return Instructions.Num() > 0;
+}
+
+float FGDDamageFormula::Evaluate(const float* Variables) const
+{
+	float Stack[MaxStackDepth];
+	int32 Top = -1;
+
+	for (const FInstruction& Instruction : Instructions)
+	{
+		switch (Instruction.Op)
+		{
+		case EOp::Constant:
+			Stack[++Top] = Instruction.Constant;
+			break;
+		case EOp::Variable:
+			Stack[++Top] = Variables[Instruction.VariableIndex];
+			break;
+		case EOp::Add:
+			Stack[Top - 1] += Stack[Top];
+			Top--;
+			break;
+		case EOp::Subtract:
+			Stack[Top - 1] -= Stack[Top];
+			Top--;
+			break;
+		case EOp::Multiply:
+			Stack[Top - 1] *= Stack[Top];
+			Top--;
+			break;
+		case EOp::Divide:
+			Stack[Top - 1] /= Stack[Top];
+			Top--;
+			break;
+		case EOp::Negate:
+			Stack[Top] = -Stack[Top];
+			break;
+		case EOp::Min:
+			Stack[Top - 1] = FMath::Min(Stack[Top - 1], Stack[Top]);
+			Top--;
+			break;
+		case EOp::Max:
+			Stack[Top - 1] = FMath::Max(Stack[Top - 1], Stack[Top]);
+			Top--;
+			break;
+		}
+	}
+
+	return Top >= 0 ? Stack[Top] : 0.0f;
+}
+
+int32 FGDDamageFormula::GetNumInstructions() const
+{
+	return Instructions.Num();
+}
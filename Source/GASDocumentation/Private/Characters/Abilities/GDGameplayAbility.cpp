@@ -5,6 +5,10 @@
 #include "AbilitySystemComponent.h"
 #include "GameplayTagContainer.h"
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effect Specs Allocated"), STAT_GDEffectSpecsAllocated, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effect Specs Reused"), STAT_GDEffectSpecsReused, STATGROUP_GASDocumentation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Effect Specs Reused Total"), STAT_GDEffectSpecsReusedTotal, STATGROUP_GASDocumentation);
+
 UGDGameplayAbility::UGDGameplayAbility()
 {
 	// Default to Instance Per Actor
@@ -23,4 +27,88 @@ void UGDGameplayAbility::OnAvatarSet(const FGameplayAbilityActorInfo * ActorInfo
 	{
 		bool ActivatedAbility = ActorInfo->AbilitySystemComponent->TryActivateAbility(Spec.Handle, false);
 	}
+
+	// Specs captured from the previous avatar
+	ClearCachedEffectSpecs();
+}
+
+void UGDGameplayAbility::OnRemoveAbility(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec)
+{
+	ClearCachedEffectSpecs();
+
+	Super::OnRemoveAbility(ActorInfo, Spec);
+}
+
+FGameplayEffectSpecHandle UGDGameplayAbility::MakeCachedOutgoingGameplayEffectSpec(TSubclassOf<UGameplayEffect> GameplayEffectClass, float Level)
+{
+	// Non-instanced abilities run on the CDO for every ASC so they can't keep per ASC specs
+	if (!IsInstantiated() || !GameplayEffectClass || !CurrentActorInfo)
+	{
+		return MakeOutgoingGameplayEffectSpec(GameplayEffectClass, Level);
+	}
+
+	FGDCachedEffectSpec* CachedSpec = CachedEffectSpecs.FindByPredicate([&GameplayEffectClass, Level](const FGDCachedEffectSpec& Cached)
+	{
+		return Cached.EffectClass == GameplayEffectClass.Get() && Cached.Level == Level;
+	});
+
+	// The spec can only be reused once nothing else holds it anymore, like the projectile it was handed to. Applying a spec copies it.
+	// Dynamic asset tags are private to the spec and can't be reset, so a spec that was given some isn't reused either.
+	FGameplayEffectSpec* Spec = CachedSpec ? CachedSpec->SpecHandle.Data.Get() : nullptr;
+	if (!Spec || !CachedSpec->SpecHandle.Data.IsUnique() || Spec->GetDynamicAssetTags().Num() > 0)
+	{
+		FGameplayEffectSpecHandle NewSpecHandle = MakeOutgoingGameplayEffectSpec(GameplayEffectClass, Level);
+		if (!NewSpecHandle.IsValid())
+		{
+			return NewSpecHandle;
+		}
+
+		INC_DWORD_STAT(STAT_GDEffectSpecsAllocated);
+
+		if (CachedSpec)
+		{
+			CachedSpec->SpecHandle = NewSpecHandle;
+		}
+		else
+		{
+			CachedEffectSpecs.Add(FGDCachedEffectSpec{ GameplayEffectClass.Get(), Level, NewSpecHandle });
+		}
+
+		return NewSpecHandle;
+	}
+
+	INC_DWORD_STAT(STAT_GDEffectSpecsReused);
+	INC_DWORD_STAT(STAT_GDEffectSpecsReusedTotal);
+
+	// A fresh context so that hit results and other per application data don't leak between uses. Setting the context on an
+	// initialized spec recaptures the source's non snapshot attributes and tags, which the new spec would have captured as well.
+	Spec->SetContext(MakeEffectContext(CurrentSpecHandle, CurrentActorInfo));
+
+	// Per use state comes from the ability spec as it is now, like MakeOutgoingGameplayEffectSpec() does
+	FGameplayAbilitySpec* AbilitySpec = CurrentActorInfo->AbilitySystemComponent.IsValid() ?
+		CurrentActorInfo->AbilitySystemComponent->FindAbilitySpecFromHandle(CurrentSpecHandle) : nullptr;
+
+	Spec->SetByCallerNameMagnitudes.Reset();
+	Spec->SetByCallerTagMagnitudes.Reset();
+	Spec->DynamicGrantedTags.Reset();
+	Spec->CapturedSourceTags.GetSpecTags().Reset();
+	Spec->StackCount = 1;
+
+	ApplyAbilityTagsToGameplayEffectSpec(*Spec, AbilitySpec);
+	if (AbilitySpec)
+	{
+		Spec->SetByCallerTagMagnitudes = AbilitySpec->SetByCallerTagMagnitudes;
+	}
+
+	return CachedSpec->SpecHandle;
+}
+
+void UGDGameplayAbility::ClearCachedEffectSpecs()
+{
+	CachedEffectSpecs.Reset();
+}
+
+bool UGDGameplayAbility::PredictsImpactCues() const
+{
+	return false;
 }
@@ -0,0 +1,417 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDGameplayCueBatchSubsystem.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+#include "GameplayCueManager.h"
+#include "GASDocumentation.h"
+#include "GDFXPoolSubsystem.h"
+#include "GDGameplayAbility.h"
+#include "GDPlayerController.h"
+#include "Particles/ParticleSystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("GameplayCue Batch Flush"), STAT_GDGameplayCueBatchFlush, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("GameplayCue Batched Cues"), STAT_GDGameplayCueBatchedCues, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("GameplayCue Batch RPCs"), STAT_GDGameplayCueBatchRPCs, STATGROUP_GASDocumentation);
+
+// Sanity limit for received batches
+static const uint32 GDMaxSerializedCues = 1024;
+
+template<typename T>
+static void SerializeObject(FArchive& Ar, T*& Object)
+{
+	UObject* SerializedObject = Object;
+	Ar << SerializedObject;
+	Object = Cast<T>(SerializedObject);
+}
+
+bool FGDGameplayCueBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 NumCues = Cues.Num();
+	Ar.SerializeIntPacked(NumCues);
+
+	if (Ar.IsLoading())
+	{
+		if (NumCues > GDMaxSerializedCues)
+		{
+			Ar.SetError();
+			bOutSuccess = false;
+			return false;
+		}
+
+		Cues.SetNum(NumCues);
+	}
+
+	bOutSuccess = true;
+
+	for (FGDBatchedGameplayCue& Cue : Cues)
+	{
+		uint8 RepBits = 0;
+		if (Ar.IsSaving())
+		{
+			if (Cue.CueTag.IsValid())
+			{
+				RepBits |= 1 << 0;
+			}
+			else if (Cue.Emitter)
+			{
+				RepBits |= 1 << 1;
+			}
+			if (Cue.Target)
+			{
+				RepBits |= 1 << 2;
+			}
+			if (Cue.Instigator)
+			{
+				RepBits |= 1 << 3;
+			}
+			if (Cue.EffectCauser && Cue.EffectCauser != Cue.Instigator)
+			{
+				RepBits |= 1 << 4;
+			}
+			if (!Cue.Normal.IsZero())
+			{
+				RepBits |= 1 << 5;
+			}
+		}
+
+		Ar.SerializeBits(&RepBits, 6);
+
+		bool bSuccess = true;
+		if (RepBits & (1 << 0))
+		{
+			Cue.CueTag.NetSerialize(Ar, Map, bSuccess);
+		}
+		if (RepBits & (1 << 1))
+		{
+			SerializeObject(Ar, Cue.Emitter);
+		}
+		if (RepBits & (1 << 2))
+		{
+			SerializeObject(Ar, Cue.Target);
+		}
+		if (RepBits & (1 << 3))
+		{
+			SerializeObject(Ar, Cue.Instigator);
+		}
+		if (RepBits & (1 << 4))
+		{
+			SerializeObject(Ar, Cue.EffectCauser);
+		}
+		else if (Ar.IsLoading())
+		{
+			Cue.EffectCauser = Cue.Instigator;
+		}
+
+		Cue.Location.NetSerialize(Ar, Map, bSuccess);
+
+		if (RepBits & (1 << 5))
+		{
+			Cue.Normal.NetSerialize(Ar, Map, bSuccess);
+		}
+
+		bOutSuccess &= bSuccess;
+	}
+
+	return true;
+}
+
+UGDGameplayCueBatchSubsystem::UGDGameplayCueBatchSubsystem()
+{
+	MaxCuesPerBatch = 32;
+	EmitterCullDistance = 15000.0f;
+}
+
+UGDGameplayCueBatchSubsystem* UGDGameplayCueBatchSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UGDGameplayCueBatchSubsystem>() : nullptr;
+}
+
+bool UGDGameplayCueBatchSubsystem::ShouldBatchCues(const UAbilitySystemComponent* OwningComponent, const TArray<FGameplayTag>& Tags) const
+{
+	if (!OwningComponent || !OwningComponent->IsOwnerActorAuthoritative() || !IsBatchingWorld(OwningComponent->GetWorld()) || Tags.Num() == 0)
+	{
+		return false;
+	}
+
+	for (const FGameplayTag& Tag : Tags)
+	{
+		if (!BatchedCueTagContainer.HasTagExact(Tag))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void UGDGameplayCueBatchSubsystem::QueueGameplayCues(UAbilitySystemComponent* OwningComponent, const TArray<FGameplayTag>& Tags, const FGameplayCueParameters& Parameters)
+{
+	AActor* Target = OwningComponent ? OwningComponent->AvatarActor.Get() : nullptr;
+	if (!Target)
+	{
+		return;
+	}
+
+	FGDQueuedGameplayCue QueuedCue;
+	FGDBatchedGameplayCue& Cue = QueuedCue.Cue;
+	Cue.Target = Target;
+	Cue.Instigator = Parameters.Instigator.Get();
+	Cue.EffectCauser = Parameters.EffectCauser.Get();
+	Cue.Location = Parameters.Location;
+	Cue.Normal = Parameters.Normal;
+
+	const FHitResult* Hit = Parameters.EffectContext.GetHitResult();
+	if (Cue.Location.IsZero())
+	{
+		if (Hit)
+		{
+			Cue.Location = Hit->ImpactPoint;
+			Cue.Normal = Hit->ImpactNormal;
+		}
+		else
+		{
+			Cue.Location = Target->GetActorLocation();
+		}
+	}
+
+	// The instigating client already played the cue on its predicted projectile
+	const UGDGameplayAbility* Ability = Cast<UGDGameplayAbility>(Parameters.EffectContext.GetAbility());
+	if (Ability && Ability->PredictsImpactCues())
+	{
+		const APawn* InstigatorPawn = Cast<APawn>(Cue.EffectCauser);
+		const APlayerState* InstigatorPlayerState = Cast<APlayerState>(Cue.Instigator);
+		QueuedCue.PredictingController = InstigatorPawn ? InstigatorPawn->GetController() : InstigatorPlayerState ? Cast<AController>(InstigatorPlayerState->GetOwner()) : nullptr;
+	}
+
+	UWorld* World = Target->GetWorld();
+	const bool bExecuteLocally = World && World->GetNetMode() == NM_ListenServer;
+
+	for (const FGameplayTag& Tag : Tags)
+	{
+		Cue.CueTag = Tag;
+		QueuedCues.Add(QueuedCue);
+		INC_DWORD_STAT(STAT_GDGameplayCueBatchedCues);
+
+		if (bExecuteLocally)
+		{
+			OwningComponent->InvokeGameplayCueEvent(Tag, EGameplayCueEvent::Executed, Parameters);
+		}
+	}
+}
+
+void UGDGameplayCueBatchSubsystem::QueueEmitter(UParticleSystem* Emitter, const FVector& Location, AActor* RelevantActor)
+{
+	UWorld* World = GetTickableGameObjectWorld();
+	if (!Emitter || !World)
+	{
+		return;
+	}
+
+	FGDQueuedGameplayCue QueuedCue;
+	QueuedCue.Cue.Emitter = Emitter;
+	QueuedCue.Cue.Location = Location;
+
+	// Clients can't resolve references to actors that aren't replicated. Relevancy falls back to the Location.
+	if (RelevantActor && RelevantActor->GetIsReplicated())
+	{
+		QueuedCue.Cue.Target = RelevantActor;
+	}
+
+	if (World->GetNetMode() != NM_DedicatedServer)
+	{
+		ExecuteCue(World, QueuedCue.Cue);
+	}
+
+	if (IsBatchingWorld(World))
+	{
+		QueuedCues.Add(QueuedCue);
+		INC_DWORD_STAT(STAT_GDGameplayCueBatchedCues);
+	}
+}
+
+void UGDGameplayCueBatchSubsystem::FlushQueuedCues()
+{
+	SCOPE_CYCLE_COUNTER(STAT_GDGameplayCueBatchFlush);
+
+	UWorld* World = GetTickableGameObjectWorld();
+	if (!World || QueuedCues.Num() == 0)
+	{
+		QueuedCues.Reset();
+		return;
+	}
+
+	FGDGameplayCueBatch Batch;
+
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		AGDPlayerController* PlayerController = Cast<AGDPlayerController>(It->Get());
+		if (!PlayerController || PlayerController->IsLocalController() || !PlayerController->GetNetConnection())
+		{
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		for (const FGDQueuedGameplayCue& QueuedCue : QueuedCues)
+		{
+			if (!IsRelevantTo(QueuedCue, PlayerController, ViewLocation))
+			{
+				continue;
+			}
+
+			Batch.Cues.Add(QueuedCue.Cue);
+			if (Batch.Cues.Num() >= MaxCuesPerBatch)
+			{
+				SendBatch(PlayerController, Batch);
+			}
+		}
+
+		SendBatch(PlayerController, Batch);
+	}
+
+	QueuedCues.Reset();
+}
+
+void UGDGameplayCueBatchSubsystem::ExecuteBatch(UWorld* World, const FGDGameplayCueBatch& Batch) const
+{
+	for (const FGDBatchedGameplayCue& Cue : Batch.Cues)
+	{
+		ExecuteCue(World, Cue);
+	}
+}
+
+void UGDGameplayCueBatchSubsystem::ExecuteCue(UWorld* World, const FGDBatchedGameplayCue& Cue)
+{
+	if (!Cue.CueTag.IsValid())
+	{
+		if (Cue.Emitter && World)
+		{
+			UGDFXPoolSubsystem::SpawnPooledEmitterAtLocation(World, Cue.Emitter, Cue.Location, FRotator::ZeroRotator, EGDFXPriority::Low);
+		}
+
+		return;
+	}
+
+	// The target can be missing if it wasn't relevant yet when the batch arrived
+	UGameplayCueManager* CueManager = UAbilitySystemGlobals::Get().GetGameplayCueManager();
+	if (!Cue.Target || !CueManager)
+	{
+		return;
+	}
+
+	FGameplayCueParameters Parameters;
+	Parameters.OriginalTag = Cue.CueTag;
+	Parameters.Location = Cue.Location;
+	Parameters.Normal = Cue.Normal;
+	Parameters.Instigator = Cue.Instigator;
+	Parameters.EffectCauser = Cue.EffectCauser;
+
+	// Cues written against the full effect context can still read the hit from it
+	FHitResult Hit;
+	Hit.bBlockingHit = true;
+	Hit.Location = Hit.ImpactPoint = Cue.Location;
+	Hit.Normal = Hit.ImpactNormal = Cue.Normal;
+
+	FGameplayEffectContextHandle Context(UAbilitySystemGlobals::Get().AllocGameplayEffectContext());
+	Context.AddInstigator(Cue.Instigator, Cue.EffectCauser);
+	Context.AddHitResult(Hit);
+	Parameters.EffectContext = Context;
+
+	CueManager->HandleGameplayCue(Cue.Target, Cue.CueTag, EGameplayCueEvent::Executed, Parameters);
+}
+
+void UGDGameplayCueBatchSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Cache tags
+	for (const FName& TagName : BatchedCueTags)
+	{
+		BatchedCueTagContainer.AddTag(FGameplayTag::RequestGameplayTag(TagName));
+	}
+}
+
+void UGDGameplayCueBatchSubsystem::Deinitialize()
+{
+	QueuedCues.Empty();
+
+	Super::Deinitialize();
+}
+
+void UGDGameplayCueBatchSubsystem::Tick(float DeltaTime)
+{
+	FlushQueuedCues();
+}
+
+bool UGDGameplayCueBatchSubsystem::IsTickable() const
+{
+	return !HasAnyFlags(RF_ClassDefaultObject) && QueuedCues.Num() > 0;
+}
+
+TStatId UGDGameplayCueBatchSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGDGameplayCueBatchSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UGDGameplayCueBatchSubsystem::GetTickableGameObjectWorld() const
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	return GameInstance ? GameInstance->GetWorld() : nullptr;
+}
+
+bool UGDGameplayCueBatchSubsystem::IsBatchingWorld(const UWorld* World) const
+{
+	if (!World)
+	{
+		return false;
+	}
+
+	const ENetMode NetMode = World->GetNetMode();
+	return NetMode == NM_DedicatedServer || NetMode == NM_ListenServer;
+}
+
+bool UGDGameplayCueBatchSubsystem::IsRelevantTo(const FGDQueuedGameplayCue& QueuedCue, AGDPlayerController* PlayerController, const FVector& ViewLocation) const
+{
+	if (QueuedCue.PredictingController.Get() == PlayerController)
+	{
+		return false;
+	}
+
+	// Same check the NetDriver uses to decide whether the target replicates to this connection
+	if (IsValid(QueuedCue.Cue.Target))
+	{
+		return QueuedCue.Cue.Target->IsNetRelevantFor(PlayerController, PlayerController->GetViewTarget(), ViewLocation);
+	}
+
+	// Emitters outlive the actor they hit
+	if (QueuedCue.Cue.CueTag.IsValid())
+	{
+		return false;
+	}
+
+	return FVector::DistSquared(ViewLocation, QueuedCue.Cue.Location) <= FMath::Square(EmitterCullDistance);
+}
+
+void UGDGameplayCueBatchSubsystem::SendBatch(AGDPlayerController* PlayerController, FGDGameplayCueBatch& Batch)
+{
+	if (Batch.Cues.Num() == 0)
+	{
+		return;
+	}
+
+	PlayerController->ClientExecuteGameplayCueBatch(Batch);
+	INC_DWORD_STAT(STAT_GDGameplayCueBatchRPCs);
+
+	Batch.Cues.Reset();
+}
@@ -0,0 +1,64 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDGameplayCueManager.h"
+#include "AbilitySystemGlobals.h"
+#include "GameplayEffect.h"
+#include "GDGameplayCueBatchSubsystem.h"
+
+bool UGDGameplayCueManager::ProcessPendingCueExecute(FGameplayCuePendingExecute& PendingCue)
+{
+	if (!Super::ProcessPendingCueExecute(PendingCue))
+	{
+		return false;
+	}
+
+	// Predicted cues already played on the predicting client. The engine's RPC carries the PredictionKey so that client skips it.
+	UGDGameplayCueBatchSubsystem* BatchSubsystem = PendingCue.OwningComponent ? UGDGameplayCueBatchSubsystem::Get(PendingCue.OwningComponent) : nullptr;
+	if (!BatchSubsystem || PendingCue.PredictionKey.IsValidKey())
+	{
+		return true;
+	}
+
+	TArray<FGameplayTag> Tags;
+	if (PendingCue.PayloadType == EGameplayCuePayloadType::FromSpec)
+	{
+		if (!PendingCue.FromSpec.Def)
+		{
+			return true;
+		}
+
+		for (const FGameplayEffectCue& EffectCue : PendingCue.FromSpec.Def->GameplayCues)
+		{
+			Tags.Append(EffectCue.GameplayCueTags.GetGameplayTagArray());
+		}
+	}
+	else
+	{
+		Tags = PendingCue.GameplayCueTags;
+	}
+
+	if (!BatchSubsystem->ShouldBatchCues(PendingCue.OwningComponent, Tags))
+	{
+		return true;
+	}
+
+	FGameplayCueParameters Parameters;
+	switch (PendingCue.PayloadType)
+	{
+	case EGameplayCuePayloadType::FromSpec:
+		UAbilitySystemGlobals::Get().InitGameplayCueParameters_GESpec(Parameters, PendingCue.FromSpec);
+		break;
+	case EGameplayCuePayloadType::EffectContext:
+		UAbilitySystemGlobals::Get().InitGameplayCueParameters(Parameters, PendingCue.CueParameters.EffectContext);
+		break;
+	default:
+		Parameters = PendingCue.CueParameters;
+		break;
+	}
+
+	BatchSubsystem->QueueGameplayCues(PendingCue.OwningComponent, Tags, Parameters);
+
+	// Sent in the batch instead
+	return false;
+}
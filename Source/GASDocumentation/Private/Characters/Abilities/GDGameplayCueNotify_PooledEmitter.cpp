@@ -0,0 +1,39 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDGameplayCueNotify_PooledEmitter.h"
+#include "GameFramework/Actor.h"
+
+UGDGameplayCueNotify_PooledEmitter::UGDGameplayCueNotify_PooledEmitter()
+{
+	Emitter = nullptr;
+	Priority = EGDFXPriority::Low;
+}
+
+bool UGDGameplayCueNotify_PooledEmitter::OnExecute_Implementation(AActor* MyTarget, const FGameplayCueParameters& Parameters) const
+{
+	if (!Emitter || !MyTarget)
+	{
+		return false;
+	}
+
+	FVector Location = Parameters.Location;
+	FVector Normal = Parameters.Normal;
+
+	const FHitResult* Hit = Parameters.EffectContext.GetHitResult();
+	if (Location.IsZero())
+	{
+		if (Hit)
+		{
+			Location = Hit->ImpactPoint;
+			Normal = Hit->ImpactNormal;
+		}
+		else
+		{
+			Location = MyTarget->GetActorLocation();
+		}
+	}
+
+	UGDFXPoolSubsystem::SpawnPooledEmitterAtLocation(MyTarget, Emitter, Location, Normal.IsZero() ? FRotator::ZeroRotator : Normal.Rotation(), Priority);
+	return true;
+}
@@ -0,0 +1,130 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDGameplayEffectTypes.h"
+#include "Engine/EngineTypes.h"
+#include "UObject/CoreNet.h"
+
+bool FGDGameplayEffectContext::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// Same as FGameplayEffectContext::NetSerialize() except for the hit result
+	uint8 RepBits = 0;
+	if (Ar.IsSaving())
+	{
+		if (Instigator.IsValid())
+		{
+			RepBits |= 1 << 0;
+		}
+		if (EffectCauser.IsValid())
+		{
+			RepBits |= 1 << 1;
+		}
+		if (AbilityCDO.IsValid())
+		{
+			RepBits |= 1 << 2;
+		}
+		if (bReplicateSourceObject && SourceObject.IsValid())
+		{
+			RepBits |= 1 << 3;
+		}
+		if (Actors.Num() > 0)
+		{
+			RepBits |= 1 << 4;
+		}
+		if (HitResult.IsValid())
+		{
+			RepBits |= 1 << 5;
+		}
+		if (bHasWorldOrigin)
+		{
+			RepBits |= 1 << 6;
+		}
+	}
+
+	Ar.SerializeBits(&RepBits, 7);
+
+	if (RepBits & (1 << 0))
+	{
+		Ar << Instigator;
+	}
+	if (RepBits & (1 << 1))
+	{
+		Ar << EffectCauser;
+	}
+	if (RepBits & (1 << 2))
+	{
+		Ar << AbilityCDO;
+	}
+	if (RepBits & (1 << 3))
+	{
+		Ar << SourceObject;
+	}
+	if (RepBits & (1 << 4))
+	{
+		SafeNetSerializeTArray_Default<31>(Ar, Actors);
+	}
+	if (RepBits & (1 << 5))
+	{
+		FVector_NetQuantize ImpactPoint;
+		FVector_NetQuantizeNormal ImpactNormal;
+		if (Ar.IsSaving())
+		{
+			ImpactPoint = HitResult->ImpactPoint;
+			ImpactNormal = HitResult->ImpactNormal;
+		}
+
+		ImpactPoint.NetSerialize(Ar, Map, bOutSuccess);
+		ImpactNormal.NetSerialize(Ar, Map, bOutSuccess);
+
+		if (Ar.IsLoading())
+		{
+			if (!HitResult.IsValid())
+			{
+				HitResult = TSharedPtr<FHitResult>(new FHitResult());
+			}
+
+			HitResult->bBlockingHit = true;
+			HitResult->Location = ImpactPoint;
+			HitResult->ImpactPoint = ImpactPoint;
+			HitResult->Normal = ImpactNormal;
+			HitResult->ImpactNormal = ImpactNormal;
+		}
+	}
+	else if (Ar.IsLoading())
+	{
+		HitResult.Reset();
+	}
+	if (RepBits & (1 << 6))
+	{
+		Ar << WorldOrigin;
+		bHasWorldOrigin = true;
+	}
+	else
+	{
+		bHasWorldOrigin = false;
+	}
+
+	if (Ar.IsLoading())
+	{
+		// Just to initialize InstigatorAbilitySystemComponent
+		AddInstigator(Instigator.Get(), EffectCauser.Get());
+	}
+
+	bOutSuccess = true;
+	return true;
+}
+
+void FGDGameplayEffectContext::MeasureNetSerialize(const FGDGameplayEffectContext& Context, UPackageMap* Map, int64& OutBaseBits, int64& OutCompactBits)
+{
+	bool bSuccess = false;
+
+	FGameplayEffectContext BaseContext = Context;
+	FNetBitWriter BaseWriter(Map, 8192);
+	BaseContext.NetSerialize(BaseWriter, Map, bSuccess);
+	OutBaseBits = BaseWriter.GetNumBits();
+
+	FGDGameplayEffectContext CompactContext = Context;
+	FNetBitWriter CompactWriter(Map, 8192);
+	CompactContext.NetSerialize(CompactWriter, Map, bSuccess);
+	OutCompactBits = CompactWriter.GetNumBits();
+}
@@ -0,0 +1,107 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDHitscanTraceSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "GASDocumentation.h"
+
+DECLARE_CYCLE_STAT(TEXT("Hitscan Flush"), STAT_GDHitscanFlush, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitscan Traces"), STAT_GDHitscanTraces, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Hitscan Batches"), STAT_GDHitscanBatches, STATGROUP_GASDocumentation);
+
+UGDHitscanTraceSubsystem* UGDHitscanTraceSubsystem::Get(const AActor* Actor)
+{
+	UGameInstance* GameInstance = Actor ? Actor->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UGDHitscanTraceSubsystem>() : nullptr;
+}
+
+void UGDHitscanTraceSubsystem::QueueLineTrace(const FVector& Start, const FVector& End, ECollisionChannel TraceChannel, const FCollisionQueryParams& QueryParams, const FGDHitscanTraceDelegate& OnComplete)
+{
+	PendingTraces.Add(FGDHitscanTraceRequest{ Start, End, TraceChannel, QueryParams, OnComplete });
+}
+
+void UGDHitscanTraceSubsystem::FlushPendingTraces()
+{
+	SCOPE_CYCLE_COUNTER(STAT_GDHitscanFlush);
+
+	UWorld* World = GetTickableGameObjectWorld();
+	if (!World || PendingTraces.Num() == 0)
+	{
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_GDHitscanBatches);
+	INC_DWORD_STAT_BY(STAT_GDHitscanTraces, PendingTraces.Num());
+
+	for (const FGDHitscanTraceRequest& Request : PendingTraces)
+	{
+		const uint32 TraceId = NextTraceId++;
+		InFlightTraces.Add(TraceId, Request.OnComplete);
+
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Request.Start, Request.End, Request.TraceChannel, Request.QueryParams,
+			FCollisionResponseParams::DefaultResponseParam, &TraceCompleteDelegate, TraceId);
+	}
+
+	PendingTraces.Reset();
+}
+
+int32 UGDHitscanTraceSubsystem::GetNumPendingTraces() const
+{
+	return PendingTraces.Num();
+}
+
+void UGDHitscanTraceSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	NextTraceId = 0;
+	TraceCompleteDelegate.BindUObject(this, &UGDHitscanTraceSubsystem::OnTraceComplete);
+}
+
+void UGDHitscanTraceSubsystem::Deinitialize()
+{
+	TraceCompleteDelegate.Unbind();
+	PendingTraces.Empty();
+	InFlightTraces.Empty();
+
+	Super::Deinitialize();
+}
+
+void UGDHitscanTraceSubsystem::Tick(float DeltaTime)
+{
+	FlushPendingTraces();
+}
+
+bool UGDHitscanTraceSubsystem::IsTickable() const
+{
+	return !HasAnyFlags(RF_ClassDefaultObject) && PendingTraces.Num() > 0;
+}
+
+TStatId UGDHitscanTraceSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGDHitscanTraceSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UGDHitscanTraceSubsystem::GetTickableGameObjectWorld() const
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	return GameInstance ? GameInstance->GetWorld() : nullptr;
+}
+
+void UGDHitscanTraceSubsystem::OnTraceComplete(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	FGDHitscanTraceDelegate OnComplete;
+	if (!InFlightTraces.RemoveAndCopyValue(TraceDatum.UserData, OnComplete))
+	{
+		return;
+	}
+
+	if (TraceDatum.OutHits.Num() > 0)
+	{
+		OnComplete.ExecuteIfBound(TraceDatum.OutHits[0]);
+	}
+	else
+	{
+		OnComplete.ExecuteIfBound(FHitResult(TraceDatum.Start, TraceDatum.End));
+	}
+}
@@ -0,0 +1,249 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDRegenSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "GASDocumentation.h"
+#include "GDAbilitySystemComponent.h"
+#include "GDAttributeSetBase.h"
+
+DECLARE_CYCLE_STAT(TEXT("Regen Update"), STAT_GDRegenUpdate, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Regen Attribute Writes"), STAT_GDRegenAttributeWrites, STATGROUP_GASDocumentation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Regen Registered ASCs"), STAT_GDRegenRegistered, STATGROUP_GASDocumentation);
+
+UGDRegenSubsystem::UGDRegenSubsystem()
+{
+	bEnabled = false;
+	UpdatesPerSecond = 10.0f;
+	NotifyThreshold = 1.0f;
+	TimeSinceLastUpdate = 0.0f;
+}
+
+UGDRegenSubsystem* UGDRegenSubsystem::Get(const AActor* Actor)
+{
+	UGameInstance* GameInstance = Actor ? Actor->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UGDRegenSubsystem>() : nullptr;
+}
+
+void UGDRegenSubsystem::RegisterAbilitySystemComponent(UGDAbilitySystemComponent* AbilitySystemComponent)
+{
+	if (!bEnabled || !AbilitySystemComponent || AbilitySystemComponents.Contains(AbilitySystemComponent))
+	{
+		return;
+	}
+
+	AbilitySystemComponents.Add(AbilitySystemComponent);
+	AttributeSets.Add(nullptr);
+
+	for (FGDRegenChannel& Channel : Channels)
+	{
+		Channel.Values.Add(0.0f);
+		Channel.MaxValues.Add(0.0f);
+		Channel.Rates.Add(0.0f);
+		Channel.Pending.Add(0.0f);
+	}
+
+	SET_DWORD_STAT(STAT_GDRegenRegistered, AbilitySystemComponents.Num());
+}
+
+void UGDRegenSubsystem::UnregisterAbilitySystemComponent(UGDAbilitySystemComponent* AbilitySystemComponent)
+{
+	const int32 Index = AbilitySystemComponents.IndexOfByKey(AbilitySystemComponent);
+	if (Index != INDEX_NONE)
+	{
+		RemoveAtSwap(Index);
+	}
+}
+
+void UGDRegenSubsystem::UpdateRegen(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GDRegenUpdate);
+
+	const int32 Num = AbilitySystemComponents.Num();
+
+	// Gather. The values can change between updates from damage, costs and other GameplayEffects.
+	TArray<bool, TInlineAllocator<256>> bActive;
+	bActive.SetNumUninitialized(Num);
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		bActive[Index] = GatherValues(Index);
+	}
+
+	// Integrate every channel in one contiguous pass
+	TArray<bool, TInlineAllocator<256>> bShouldCommit;
+	bShouldCommit.SetNumZeroed(Num * GDRR_Num);
+	const float Threshold = FMath::Max(NotifyThreshold, KINDA_SMALL_NUMBER);
+
+	for (int32 ChannelIndex = 0; ChannelIndex < GDRR_Num; ChannelIndex++)
+	{
+		FGDRegenChannel& Channel = Channels[ChannelIndex];
+		for (int32 Index = 0; Index < Num; Index++)
+		{
+			if (!bActive[Index] || Channel.Rates[Index] == 0.0f)
+			{
+				Channel.Pending[Index] = 0.0f;
+				continue;
+			}
+
+			const float Value = Channel.Values[Index];
+			const float NewValue = FMath::Clamp(Value + Channel.Pending[Index] + Channel.Rates[Index] * DeltaTime, 0.0f, Channel.MaxValues[Index]);
+
+			// Only keep the regen that fits. Regen accumulated while at max (or 0) would otherwise all apply at once after the next hit.
+			Channel.Pending[Index] = NewValue - Value;
+
+			const bool bCrossedThreshold = FMath::FloorToInt(NewValue / Threshold) != FMath::FloorToInt(Value / Threshold);
+			const bool bReachedLimit = NewValue != Value && (NewValue >= Channel.MaxValues[Index] || NewValue <= 0.0f);
+
+			if (bCrossedThreshold || bReachedLimit)
+			{
+				Channel.Values[Index] = NewValue;
+				Channel.Pending[Index] = 0.0f;
+				bShouldCommit[Index * GDRR_Num + ChannelIndex] = true;
+			}
+		}
+	}
+
+	// Commit on the game thread through the ASC so that attribute change delegates fire and the values replicate
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		if (bActive[Index])
+		{
+			CommitValues(Index, &bShouldCommit[Index * GDRR_Num]);
+		}
+	}
+}
+
+void UGDRegenSubsystem::Deinitialize()
+{
+	AbilitySystemComponents.Empty();
+	AttributeSets.Empty();
+
+	for (FGDRegenChannel& Channel : Channels)
+	{
+		Channel = FGDRegenChannel();
+	}
+
+	Super::Deinitialize();
+}
+
+void UGDRegenSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceLastUpdate += DeltaTime;
+
+	const float UpdateInterval = 1.0f / FMath::Max(UpdatesPerSecond, 1.0f);
+	if (TimeSinceLastUpdate < UpdateInterval)
+	{
+		return;
+	}
+
+	// Drop ASCs that were destroyed without unregistering
+	for (int32 Index = AbilitySystemComponents.Num() - 1; Index >= 0; Index--)
+	{
+		if (!AbilitySystemComponents[Index].IsValid())
+		{
+			RemoveAtSwap(Index);
+		}
+	}
+
+	UpdateRegen(TimeSinceLastUpdate);
+	TimeSinceLastUpdate = 0.0f;
+}
+
+bool UGDRegenSubsystem::IsTickable() const
+{
+	return !HasAnyFlags(RF_ClassDefaultObject) && bEnabled && AbilitySystemComponents.Num() > 0;
+}
+
+TStatId UGDRegenSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGDRegenSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UGDRegenSubsystem::GetTickableGameObjectWorld() const
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	return GameInstance ? GameInstance->GetWorld() : nullptr;
+}
+
+void UGDRegenSubsystem::RemoveAtSwap(int32 Index)
+{
+	AbilitySystemComponents.RemoveAtSwap(Index, 1, false);
+	AttributeSets.RemoveAtSwap(Index, 1, false);
+
+	for (FGDRegenChannel& Channel : Channels)
+	{
+		Channel.Values.RemoveAtSwap(Index, 1, false);
+		Channel.MaxValues.RemoveAtSwap(Index, 1, false);
+		Channel.Rates.RemoveAtSwap(Index, 1, false);
+		Channel.Pending.RemoveAtSwap(Index, 1, false);
+	}
+
+	SET_DWORD_STAT(STAT_GDRegenRegistered, AbilitySystemComponents.Num());
+}
+
+bool UGDRegenSubsystem::GatherValues(int32 Index)
+{
+	UGDAbilitySystemComponent* ASC = AbilitySystemComponents[Index].Get();
+	if (!ASC)
+	{
+		return false;
+	}
+
+	UGDAttributeSetBase* AttributeSet = AttributeSets[Index].Get();
+	if (!AttributeSet)
+	{
+		AttributeSet = const_cast<UGDAttributeSetBase*>(ASC->GetSet<UGDAttributeSetBase>());
+		if (!AttributeSet)
+		{
+			return false;
+		}
+
+		AttributeSets[Index] = AttributeSet;
+	}
+
+	// The dead don't regenerate
+	if (AttributeSet->GetHealth() <= 0.0f)
+	{
+		return false;
+	}
+
+	// Base values since that's what gets written back
+	Channels[GDRR_Health].Values[Index] = ASC->GetNumericAttributeBase(UGDAttributeSetBase::GetHealthAttribute());
+	Channels[GDRR_Health].MaxValues[Index] = AttributeSet->GetMaxHealth();
+	Channels[GDRR_Health].Rates[Index] = AttributeSet->GetHealthRegenRate();
+
+	Channels[GDRR_Mana].Values[Index] = ASC->GetNumericAttributeBase(UGDAttributeSetBase::GetManaAttribute());
+	Channels[GDRR_Mana].MaxValues[Index] = AttributeSet->GetMaxMana();
+	Channels[GDRR_Mana].Rates[Index] = AttributeSet->GetManaRegenRate();
+
+	Channels[GDRR_Stamina].Values[Index] = ASC->GetNumericAttributeBase(UGDAttributeSetBase::GetStaminaAttribute());
+	Channels[GDRR_Stamina].MaxValues[Index] = AttributeSet->GetMaxStamina();
+	Channels[GDRR_Stamina].Rates[Index] = AttributeSet->GetStaminaRegenRate();
+
+	return true;
+}
+
+void UGDRegenSubsystem::CommitValues(int32 Index, const bool* bShouldCommit)
+{
+	UGDAbilitySystemComponent* ASC = AbilitySystemComponents[Index].Get();
+	if (!ASC)
+	{
+		return;
+	}
+
+	static const FGameplayAttribute Attributes[GDRR_Num] =
+	{
+		UGDAttributeSetBase::GetHealthAttribute(),
+		UGDAttributeSetBase::GetManaAttribute(),
+		UGDAttributeSetBase::GetStaminaAttribute()
+	};
+
+	for (int32 ChannelIndex = 0; ChannelIndex < GDRR_Num; ChannelIndex++)
+	{
+		if (bShouldCommit[ChannelIndex])
+		{
+			ASC->SetNumericAttributeBase(Attributes[ChannelIndex], Channels[ChannelIndex].Values[Index]);
+			INC_DWORD_STAT(STAT_GDRegenAttributeWrites);
+		}
+	}
+}
@@ -5,10 +5,14 @@
 #include "Abilities/AttributeSets/GDAttributeSetBase.h"
 #include "Abilities/GDGameplayAbility.h"
 #include "Components/CapsuleComponent.h"
+#include "GASDocumentation.h"
 #include "GDAbilitySystemComponent.h"
 #include "GDCharacterMovementComponent.h"
+#include "GDCombatEventSubsystem.h"
 #include "GDDamageTextWidgetComponent.h"
 
+DECLARE_CYCLE_STAT(TEXT("Character Die"), STAT_GDCharacterDie, STATGROUP_GASDocumentation);
+
 // Sets default values
 AGDCharacterBase::AGDCharacterBase(const class FObjectInitializer& ObjectInitializer) :
 	Super(ObjectInitializer.SetDefaultSubobjectClass<UGDCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
@@ -231,6 +235,10 @@ float AGDCharacterBase::GetMoveSpeedBaseValue() const
 void AGDCharacterBase::Die()
 {
 	// Only runs on Server
+	SCOPE_CYCLE_COUNTER(STAT_GDCharacterDie);
+	CSV_SCOPED_TIMING_STAT(GASDocumentation, Die);
+	FGDCombatTelemetryScope TelemetryScope(AbilitySystemComponent ? &AbilitySystemComponent->Telemetry.DieCycles : nullptr);
+
 	RemoveCharacterAbilities();
 
 	GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
@@ -239,6 +247,8 @@ void AGDCharacterBase::Die()
 
 	OnCharacterDied.Broadcast(this);
 
+	UGDCombatEventSubsystem::Record(EGDCombatEventType::Death, nullptr, this);
+
 	if (AbilitySystemComponent)
 	{
 		AbilitySystemComponent->CancelAllAbilities();
@@ -247,7 +257,11 @@ void AGDCharacterBase::Die()
 		EffectTagsToRemove.AddTag(EffectRemoveOnDeathTag);
 		int32 NumEffectsRemoved = AbilitySystemComponent->RemoveActiveEffectsWithTags(EffectTagsToRemove);
 
-		AbilitySystemComponent->AddLooseGameplayTag(DeadTag);
+		// May already be there if the death was gated by UGDCrowdControlSubsystem::ApplyDeath()
+		if (!AbilitySystemComponent->HasMatchingGameplayTag(DeadTag))
+		{
+			AbilitySystemComponent->AddLooseGameplayTag(DeadTag);
+		}
 	}
 
 	if (DeathMontage)
@@ -322,6 +336,9 @@ void AGDCharacterBase::AddStartupEffects()
 	FGameplayEffectContextHandle EffectContext = AbilitySystemComponent->MakeEffectContext();
 	EffectContext.AddSourceObject(this);
 
+	// Rescale current values once after all of the startup effects instead of after each one
+	FGDScopedMaxAttributeRescale RescaleScope(AbilitySystemComponent);
+
 	for (TSubclassOf<UGameplayEffect> GameplayEffect : StartupEffects)
 	{
 		FGameplayEffectSpecHandle NewHandle = AbilitySystemComponent->MakeOutgoingSpec(GameplayEffect, GetCharacterLevel(), EffectContext);
@@ -4,12 +4,18 @@
 #include "GDCharacterMovementComponent.h"
 #include "AbilitySystemComponent.h"
 #include "GameplayTagContainer.h"
+#include "GDAttributeSetBase.h"
 #include "GDCharacterBase.h"
 
 UGDCharacterMovementComponent::UGDCharacterMovementComponent()
 {
 	SprintSpeedMultiplier = 1.4f;
+	SprintStaminaDrainPerSecond = 0.0f;
 	ADSSpeedMultiplier = 0.5f;
+	PendingSprintDrainSeconds = 0.0f;
+	bSprintStaminaDepleted = false;
+
+	SprintAbilityTags.AddTag(FGameplayTag::RequestGameplayTag(FName("Ability.Sprint")));
 }
 
 float UGDCharacterMovementComponent::GetMaxSpeed() const
@@ -26,7 +32,9 @@ float UGDCharacterMovementComponent::GetMaxSpeed() const
 		return 0.0f;
 	}
 
-	if (Owner->GetAbilitySystemComponent()->HasMatchingGameplayTag(FGameplayTag::RequestGameplayTag(FName("State.Debuff.Stun"))))
+	// Mass minions don't have an AbilitySystemComponent unless they've been promoted
+	UAbilitySystemComponent* ASC = Owner->GetAbilitySystemComponent();
+	if (ASC && ASC->HasMatchingGameplayTag(FGameplayTag::RequestGameplayTag(FName("State.Debuff.Stun"))))
 	{
 		return 0.0f;
 	}
@@ -53,6 +61,16 @@ void UGDCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
 	//It basically just resets the movement component to the state when the move was made so it can simulate from there.
 	RequestToStartSprinting = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
 
+	// Stays depleted until the owning client stops requesting to sprint
+	if (!RequestToStartSprinting)
+	{
+		bSprintStaminaDepleted = false;
+	}
+	else if (bSprintStaminaDepleted)
+	{
+		RequestToStartSprinting = false;
+	}
+
 	RequestToStartADS = (Flags & FSavedMove_Character::FLAG_Custom_1) != 0;
 }
 
@@ -72,9 +90,17 @@ FNetworkPredictionData_Client * UGDCharacterMovementComponent::GetPredictionData
 	return ClientPredictionData;
 }
 
+void UGDCharacterMovementComponent::OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity)
+{
+	Super::OnMovementUpdated(DeltaSeconds, OldLocation, OldVelocity);
+
+	UpdateSprintStamina(DeltaSeconds);
+}
+
 void UGDCharacterMovementComponent::StartSprinting()
 {
 	RequestToStartSprinting = true;
+	bSprintStaminaDepleted = false;
 }
 
 void UGDCharacterMovementComponent::StopSprinting()
@@ -82,6 +108,17 @@ void UGDCharacterMovementComponent::StopSprinting()
 	RequestToStartSprinting = false;
 }
 
+float UGDCharacterMovementComponent::GetPredictedStamina() const
+{
+	AGDCharacterBase* Owner = Cast<AGDCharacterBase>(GetOwner());
+	if (!Owner)
+	{
+		return 0.0f;
+	}
+
+	return FMath::Max(Owner->GetStamina() - PendingSprintDrainSeconds * SprintStaminaDrainPerSecond, 0.0f);
+}
+
 void UGDCharacterMovementComponent::StartAimDownSights()
 {
 	RequestToStartADS = true;
@@ -98,6 +135,8 @@ void UGDCharacterMovementComponent::FGDSavedMove::Clear()
 
 	SavedRequestToStartSprinting = false;
 	SavedRequestToStartADS = false;
+	SavedPendingSprintDrainSeconds = 0.0f;
+	SavedSprintStaminaDepleted = false;
 }
 
 uint8 UGDCharacterMovementComponent::FGDSavedMove::GetCompressedFlags() const
@@ -142,6 +181,8 @@ void UGDCharacterMovementComponent::FGDSavedMove::SetMoveFor(ACharacter * Charac
 	{
 		SavedRequestToStartSprinting = CharacterMovement->RequestToStartSprinting;
 		SavedRequestToStartADS = CharacterMovement->RequestToStartADS;
+		SavedPendingSprintDrainSeconds = CharacterMovement->PendingSprintDrainSeconds;
+		SavedSprintStaminaDepleted = CharacterMovement->bSprintStaminaDepleted;
 	}
 }
 
@@ -152,6 +193,80 @@ void UGDCharacterMovementComponent::FGDSavedMove::PrepMoveFor(ACharacter * Chara
 	UGDCharacterMovementComponent* CharacterMovement = Cast<UGDCharacterMovementComponent>(Character->GetCharacterMovement());
 	if (CharacterMovement)
 	{
+		CharacterMovement->PendingSprintDrainSeconds = SavedPendingSprintDrainSeconds;
+		CharacterMovement->bSprintStaminaDepleted = SavedSprintStaminaDepleted;
+	}
+}
+
+void UGDCharacterMovementComponent::FGDSavedMove::CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation)
+{
+	Super::CombineWith(OldMove, InCharacter, PC, OldStartLocation);
+
+	// The combined move replays the OldMove's time too, so it starts from the OldMove's drain instead of adding it twice
+	const FGDSavedMove* OldGDMove = static_cast<const FGDSavedMove*>(OldMove);
+	SavedPendingSprintDrainSeconds = OldGDMove->SavedPendingSprintDrainSeconds;
+	SavedSprintStaminaDepleted = OldGDMove->SavedSprintStaminaDepleted;
+
+	UGDCharacterMovementComponent* CharacterMovement = Cast<UGDCharacterMovementComponent>(InCharacter->GetCharacterMovement());
+	if (CharacterMovement)
+	{
+		CharacterMovement->PendingSprintDrainSeconds = SavedPendingSprintDrainSeconds;
+		CharacterMovement->bSprintStaminaDepleted = SavedSprintStaminaDepleted;
+	}
+}
+
+void UGDCharacterMovementComponent::UpdateSprintStamina(float DeltaSeconds)
+{
+	if (SprintStaminaDrainPerSecond <= 0.0f)
+	{
+		return;
+	}
+
+	if (!RequestToStartSprinting)
+	{
+		if (PendingSprintDrainSeconds > 0.0f)
+		{
+			CommitSprintStamina();
+		}
+
+		return;
+	}
+
+	// Moves are simulated with the same DeltaSeconds on the client and the Server so both arrive at the same drain
+	PendingSprintDrainSeconds += DeltaSeconds;
+
+	if (GetPredictedStamina() <= 0.0f)
+	{
+		RequestToStartSprinting = false;
+		bSprintStaminaDepleted = true;
+		CommitSprintStamina();
+
+		AGDCharacterBase* Owner = Cast<AGDCharacterBase>(GetOwner());
+		UAbilitySystemComponent* ASC = Owner ? Owner->GetAbilitySystemComponent() : nullptr;
+		if (ASC && GetOwnerRole() == ROLE_Authority)
+		{
+			ASC->CancelAbilities(&SprintAbilityTags);
+		}
+	}
+}
+
+void UGDCharacterMovementComponent::CommitSprintStamina()
+{
+	const float Drain = PendingSprintDrainSeconds * SprintStaminaDrainPerSecond;
+	PendingSprintDrainSeconds = 0.0f;
+
+	// The client's Stamina catches up through replication
+	if (GetOwnerRole() != ROLE_Authority)
+	{
+		return;
+	}
+
+	AGDCharacterBase* Owner = Cast<AGDCharacterBase>(GetOwner());
+	UAbilitySystemComponent* ASC = Owner ? Owner->GetAbilitySystemComponent() : nullptr;
+	if (ASC && Drain > 0.0f)
+	{
+		// In place mod. Updates the aggregator and notifies attribute change delegates without Pre/PostGameplayEffectExecute.
+		ASC->ApplyModToAttribute(UGDAttributeSetBase::GetStaminaAttribute(), EGameplayModOp::Additive, -FMath::Min(Drain, Owner->GetStamina()));
 	}
 }
 
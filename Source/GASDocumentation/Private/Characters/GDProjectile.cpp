@@ -2,7 +2,12 @@
 
 
 #include "GDProjectile.h"
+#include "AbilitySystemGlobals.h"
 #include "GameFramework/ProjectileMovementComponent.h"
+#include "GameplayCueManager.h"
+#include "GameplayPrediction.h"
+#include "GDHeroCharacter.h"
+#include "UnrealNetwork.h"
 
 // Sets default values
 AGDProjectile::AGDProjectile()
@@ -14,12 +19,131 @@ AGDProjectile::AGDProjectile()
 	bReplicateMovement = true;
 
 	ProjectileMovement = CreateDefaultSubobject<UProjectileMovementComponent>(FName("ProjectileMovement"));
+
+	PredictionId = 0;
+	bIsPredictedProjectile = false;
+	bPlayedPredictedImpactCue = false;
+}
+
+int32 AGDProjectile::MakePredictionId(const FPredictionKey& PredictionKey, int32 ShotIndex)
+{
+	return (static_cast<int32>(PredictionKey.Current) << 8) | (ShotIndex & 0xFF);
+}
+
+void AGDProjectile::InitPredictedProjectile(int32 InPredictionId)
+{
+	PredictionId = InPredictionId;
+	bIsPredictedProjectile = true;
+
+	// Only exists on the client that fired it
+	SetReplicates(false);
+	SetReplicateMovement(false);
+
+	// Clean up on our own if the Server's projectile never shows up
+	if (ProjectileMovement && ProjectileMovement->InitialSpeed > 0.0f)
+	{
+		InitialLifeSpan = Range / ProjectileMovement->InitialSpeed;
+	}
+}
+
+bool AGDProjectile::IsPredictedProjectile() const
+{
+	return bIsPredictedProjectile;
+}
+
+void AGDProjectile::OnPredictionRejected()
+{
+	Destroy();
+}
+
+void AGDProjectile::NotifyActorBeginOverlap(AActor* OtherActor)
+{
+	Super::NotifyActorBeginOverlap(OtherActor);
+
+	if (!bIsPredictedProjectile || bPlayedPredictedImpactCue || !PredictedImpactCueTag.IsValid())
+	{
+		return;
+	}
+
+	AGDCharacterBase* HitCharacter = Cast<AGDCharacterBase>(OtherActor);
+	UGameplayCueManager* CueManager = UAbilitySystemGlobals::Get().GetGameplayCueManager();
+	if (!HitCharacter || HitCharacter == Instigator || !HitCharacter->IsAlive() || !CueManager)
+	{
+		return;
+	}
+
+	bPlayedPredictedImpactCue = true;
+
+	FGameplayCueParameters Parameters;
+	Parameters.OriginalTag = PredictedImpactCueTag;
+	Parameters.Location = GetActorLocation();
+	Parameters.Normal = ProjectileMovement ? -ProjectileMovement->Velocity.GetSafeNormal() : FVector::ZeroVector;
+	Parameters.Instigator = Instigator;
+	Parameters.EffectCauser = Instigator;
+
+	CueManager->HandleGameplayCue(HitCharacter, PredictedImpactCueTag, EGameplayCueEvent::Executed, Parameters);
+}
+
+void AGDProjectile::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(AGDProjectile, PredictionId, COND_OwnerOnly);
 }
 
 // Called when the game starts or when spawned
 void AGDProjectile::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	AGDHeroCharacter* Hero = GetLocallyControlledHeroInstigator();
+	if (!Hero)
+	{
+		return;
+	}
+
+	if (bIsPredictedProjectile)
+	{
+		Hero->RegisterPredictedProjectile(this);
+	}
+	else if (Role < ROLE_Authority)
+	{
+		// The Server's projectile arrived. Hide it behind the predicted one which is already further along its path.
+		PredictedProjectile = Hero->TakePredictedProjectile(PredictionId);
+		if (PredictedProjectile.IsValid())
+		{
+			SetActorHiddenInGame(true);
+			return;
+		}
+	}
+
+	Hero->NotifyProjectileShotVisible(PredictionId);
 }
 
+void AGDProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// The Server's projectile hit something, the predicted projectile goes with it
+	if (PredictedProjectile.IsValid())
+	{
+		PredictedProjectile->Destroy();
+		PredictedProjectile.Reset();
+	}
+
+	// A predicted projectile that the Server's projectile never took, e.g. a rejected activation or one that ran out of range
+	if (bIsPredictedProjectile)
+	{
+		AGDHeroCharacter* Hero = GetLocallyControlledHeroInstigator();
+		if (Hero)
+		{
+			Hero->UnregisterPredictedProjectile(this);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+AGDHeroCharacter* AGDProjectile::GetLocallyControlledHeroInstigator() const
+{
+	AGDHeroCharacter* Hero = Cast<AGDHeroCharacter>(Instigator);
+	return Hero && Hero->IsLocallyControlled() ? Hero : nullptr;
+}
@@ -6,9 +6,10 @@
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "GDCharacterBase.h"
 #include "GDAbilitySystemComponent.h"
+#include "GDBlueprintLibrary.h"
+#include "GDGameplayCueBatchSubsystem.h"
 #include <Components/SphereComponent.h>
 #include <Components/StaticMeshComponent.h>
-#include <Kismet/GameplayStatics.h>
 
 AGDThrowableProjectile::AGDThrowableProjectile()
 	:Damage(25.0f)
@@ -69,14 +70,12 @@ void AGDThrowableProjectile::DamageCharacter(AActor* OtherCharacter)
 
 	if (AGDCharacterBase* GDCharacter{ Cast<AGDCharacterBase>(OtherCharacter) })
 	{
-		if (GDCharacter != Instigator && GDCharacter->IsAlive() && GDCharacter->GetAbilitySystemComponent())
+		if (GDCharacter != Instigator && GDCharacter->IsAlive())
 		{
+			// Also handles mass minions, which don't have an AbilitySystemComponent
 			for (const FGameplayEffectSpecHandle& EffectHandle : GameplayEffectHandles)
 			{
-				if (EffectHandle.IsValid())
-				{
-					GDCharacter->GetAbilitySystemComponent()->ApplyGameplayEffectSpecToSelf(*EffectHandle.Data.Get());
-				}
+				UGDBlueprintLibrary::ApplyGameplayEffectSpecToActor(EffectHandle, GDCharacter);
 			}
 		}
 	}
@@ -102,14 +101,18 @@ void AGDThrowableProjectile::OnCollisionOccured(UPrimitiveComponent* OverlappedC
 	{
 		if (OtherActor)
 		{
-			SpawnEmitterEffect(OtherActor->GetActorLocation());
+			SpawnEmitterEffect(OtherActor);
 		}
 
 		DamageCharacter(OtherActor);
 	}
 }
 
-void AGDThrowableProjectile::SpawnEmitterEffect_Implementation(const FVector& AtLocation)
+void AGDThrowableProjectile::SpawnEmitterEffect(AActor* HitActor)
 {
-	UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), CollisionParticles, AtLocation);
+	UGDGameplayCueBatchSubsystem* BatchSubsystem = UGDGameplayCueBatchSubsystem::Get(this);
+	if (BatchSubsystem)
+	{
+		BatchSubsystem->QueueEmitter(CollisionParticles, HitActor->GetActorLocation(), HitActor);
+	}
 }
\ No newline at end of file
@@ -5,7 +5,9 @@
 #include "AbilitySystemComponent.h"
 #include "Camera/CameraComponent.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "GDBlueprintLibrary.h"
 #include "GDHeroCharacter.h"
+#include "GDHitscanTraceSubsystem.h"
 #include "Kismet/KismetMathLibrary.h"
 
 UGDGA_FireGun::UGDGA_FireGun()
@@ -20,6 +22,15 @@ UGDGA_FireGun::UGDGA_FireGun()
 
 	Range = 1000.0f;
 	Damage = 12.0f;
+	ShotsPerActivation = 1;
+	ShotsFired = 0;
+	bPredictProjectiles = false;
+	bHitscan = false;
+	HitscanTraceChannel = ECC_Pawn;
+	ImpactCueTag = FGameplayTag::RequestGameplayTag(FName("GameplayCue.Hero.FireGun.Impact"));
+
+	SpawnProjectileEventTag = FGameplayTag::RequestGameplayTag(FName("Event.Montage.SpawnProjectile"));
+	EndAbilityEventTag = FGameplayTag::RequestGameplayTag(FName("Event.Montage.EndAbility"));
 }
 
 void UGDGA_FireGun::ActivateAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo * ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo, const FGameplayEventData * TriggerEventData)
@@ -29,75 +40,174 @@ void UGDGA_FireGun::ActivateAbility(const FGameplayAbilitySpecHandle Handle, con
 		EndAbility(CurrentSpecHandle, CurrentActorInfo, CurrentActivationInfo, true, true);
 	}
 
-	UAnimMontage* MontageToPlay = FireHipMontage;
+	UAnimMontage* MontageToPlay = GetFireMontage();
+	ShotsFired = 0;
 
-	if (GetAbilitySystemComponentFromActorInfo()->HasMatchingGameplayTag(FGameplayTag::RequestGameplayTag(FName("State.AimDownSights"))) &&
-		!GetAbilitySystemComponentFromActorInfo()->HasMatchingGameplayTag(FGameplayTag::RequestGameplayTag(FName("State.AimDownSights.Removal"))))
-	{
-		MontageToPlay = FireIronsightsMontage;
-	}
+	// Only listen for the two events we handle instead of every event sent to the ASC
+	FGameplayTagContainer EventTags;
+	EventTags.AddTag(SpawnProjectileEventTag);
+	EventTags.AddTag(EndAbilityEventTag);
 
 	// Play fire montage and wait for event telling us to spawn the projectile
-	UGDAT_PlayMontageAndWaitForEvent* Task = UGDAT_PlayMontageAndWaitForEvent::PlayMontageAndWaitForEvent(this, NAME_None, MontageToPlay, FGameplayTagContainer(), 1.0f, NAME_None, false, 1.0f);
-	Task->OnBlendOut.AddDynamic(this, &UGDGA_FireGun::OnCompleted);
-	Task->OnCompleted.AddDynamic(this, &UGDGA_FireGun::OnCompleted);
-	Task->OnInterrupted.AddDynamic(this, &UGDGA_FireGun::OnCancelled);
-	Task->OnCancelled.AddDynamic(this, &UGDGA_FireGun::OnCancelled);
-	Task->EventReceived.AddDynamic(this, &UGDGA_FireGun::EventReceived);
+	UGDAT_PlayMontageAndWaitForEvent* Task = UGDAT_PlayMontageAndWaitForEvent::PlayMontageAndWaitForEvent(this, NAME_None, MontageToPlay, EventTags, 1.0f, NAME_None, false, 1.0f, true);
+	FireMontageTask = Task;
+	Task->OnBlendOutNative.AddUObject(this, &UGDGA_FireGun::OnCompleted);
+	Task->OnCompletedNative.AddUObject(this, &UGDGA_FireGun::OnCompleted);
+	Task->OnInterruptedNative.AddUObject(this, &UGDGA_FireGun::OnCancelled);
+	Task->OnCancelledNative.AddUObject(this, &UGDGA_FireGun::OnCancelled);
+	Task->EventReceivedNative.AddUObject(this, &UGDGA_FireGun::EventReceived);
 	// ReadyForActivation() is how you activate the AbilityTask in C++. Blueprint has magic from K2Node_LatentGameplayTaskCall that will automatically call ReadyForActivation().
 	Task->ReadyForActivation();
 }
 
-void UGDGA_FireGun::OnCancelled(FGameplayTag EventTag, FGameplayEventData EventData)
+bool UGDGA_FireGun::PredictsImpactCues() const
 {
-	EndAbility(CurrentSpecHandle, CurrentActorInfo, CurrentActivationInfo, true, true);
+	return bPredictProjectiles && !bHitscan && ImpactCueTag.IsValid();
+}
+
+UAnimMontage* UGDGA_FireGun::GetFireMontage() const
+{
+	UAbilitySystemComponent* ASC = GetAbilitySystemComponentFromActorInfo();
+	if (ASC && ASC->HasMatchingGameplayTag(FGameplayTag::RequestGameplayTag(FName("State.AimDownSights"))) &&
+		!ASC->HasMatchingGameplayTag(FGameplayTag::RequestGameplayTag(FName("State.AimDownSights.Removal"))))
+	{
+		return FireIronsightsMontage;
+	}
+
+	return FireHipMontage;
 }
 
-void UGDGA_FireGun::OnCompleted(FGameplayTag EventTag, FGameplayEventData EventData)
+void UGDGA_FireGun::FinishShot()
 {
+	ShotsFired++;
+
+	if (ShotsFired < ShotsPerActivation && FireMontageTask && FireMontageTask->RestartMontage(GetFireMontage()))
+	{
+		return;
+	}
+
 	EndAbility(CurrentSpecHandle, CurrentActorInfo, CurrentActivationInfo, true, false);
 }
 
-void UGDGA_FireGun::EventReceived(FGameplayTag EventTag, FGameplayEventData EventData)
+void UGDGA_FireGun::OnCancelled(FGameplayTag EventTag, const FGameplayEventData& EventData)
+{
+	EndAbility(CurrentSpecHandle, CurrentActorInfo, CurrentActivationInfo, true, true);
+}
+
+void UGDGA_FireGun::OnCompleted(FGameplayTag EventTag, const FGameplayEventData& EventData)
+{
+	FinishShot();
+}
+
+void UGDGA_FireGun::EventReceived(FGameplayTag EventTag, const FGameplayEventData& EventData)
 {
-	// Montage told us to end the ability before the montage finished playing.
+	// Montage told us to end the shot (and the ability after the last shot) before the montage finished playing.
 	// Montage was set to continue playing animation even after ability ends so this is okay.
-	if (EventTag == FGameplayTag::RequestGameplayTag(FName("Event.Montage.EndAbility")))
+	if (EventTag == EndAbilityEventTag)
+	{
+		FinishShot();
+		return;
+	}
+
+	if (EventTag != SpawnProjectileEventTag)
+	{
+		return;
+	}
+
+	const bool bIsServer = GetOwningActorFromActorInfo()->Role == ROLE_Authority;
+	const bool bIsLocallyControlled = IsLocallyControlled();
+	const int32 PredictionId = AGDProjectile::MakePredictionId(CurrentActivationInfo.GetActivationPredictionKey(), ShotsFired);
+
+	AGDHeroCharacter* Hero = Cast<AGDHeroCharacter>(GetAvatarActorFromActorInfo());
+	if (!Hero)
 	{
-		EndAbility(CurrentSpecHandle, CurrentActorInfo, CurrentActivationInfo, true, false);
+		EndAbility(CurrentSpecHandle, CurrentActorInfo, CurrentActivationInfo, true, true);
 		return;
 	}
 
-	// Only spawn projectiles on the Server.
-	// Predicting projectiles is an advanced topic not covered in this example.
-	if (GetOwningActorFromActorInfo()->Role == ROLE_Authority && EventTag == FGameplayTag::RequestGameplayTag(FName("Event.Montage.SpawnProjectile")))
+	if (bHitscan)
 	{
-		AGDHeroCharacter* Hero = Cast<AGDHeroCharacter>(GetAvatarActorFromActorInfo());
-		if (!Hero)
+		UGDHitscanTraceSubsystem* HitscanTraceSubsystem = UGDHitscanTraceSubsystem::Get(Hero);
+		if (!bIsServer || !HitscanTraceSubsystem)
 		{
-			EndAbility(CurrentSpecHandle, CurrentActorInfo, CurrentActivationInfo, true, true);
+			return;
 		}
 
 		FVector Start = Hero->GetGunComponent()->GetSocketLocation(FName("Muzzle"));
-		FVector End = Hero->GetCameraBoom()->GetComponentLocation() + Hero->GetFollowCamera()->GetForwardVector() * Range;
-		FRotator Rotation = UKismetMathLibrary::FindLookAtRotation(Start, End);
+		FVector AimPoint = Hero->GetCameraBoom()->GetComponentLocation() + Hero->GetFollowCamera()->GetForwardVector() * Range;
+		FVector End = Start + (AimPoint - Start).GetSafeNormal() * Range;
 
-		FGameplayEffectSpecHandle DamageEffectSpecHandle = MakeOutgoingGameplayEffectSpec(DamageGameplayEffect, GetAbilityLevel());
-		
-		// Pass the damage to the Damage Execution Calculation through a SetByCaller value on the GameplayEffectSpec
+		FGameplayEffectSpecHandle DamageEffectSpecHandle = MakeCachedOutgoingGameplayEffectSpec(DamageGameplayEffect, GetAbilityLevel());
 		DamageEffectSpecHandle.Data.Get()->SetSetByCallerMagnitude(FGameplayTag::RequestGameplayTag(FName("Data.Damage")), Damage);
 
-		FTransform MuzzleTransform = Hero->GetGunComponent()->GetSocketTransform(FName("Muzzle"));
-		MuzzleTransform.SetRotation(Rotation.Quaternion());
-		MuzzleTransform.SetScale3D(FVector(1.0f));
+		FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GDHitscan), false, Hero);
 
-		FActorSpawnParameters SpawnParameters;
-		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		HitscanTraceSubsystem->QueueLineTrace(Start, End, HitscanTraceChannel, QueryParams,
+			FGDHitscanTraceDelegate::CreateUObject(this, &UGDGA_FireGun::OnHitscanTraceComplete, DamageEffectSpecHandle));
+		return;
+	}
+
+	// The Server spawns the real projectile. The owning client spawns a cosmetic predicted projectile right away if
+	// bPredictProjectiles is set, otherwise it sees the Server's projectile one round trip later.
+
+	if (bIsLocallyControlled)
+	{
+		Hero->NotifyProjectileShotFired(PredictionId);
+	}
+
+	const bool bSpawnPredictedProjectile = !bIsServer && bIsLocallyControlled && bPredictProjectiles;
+	if (!bIsServer && !bSpawnPredictedProjectile)
+	{
+		return;
+	}
+
+	FVector Start = Hero->GetGunComponent()->GetSocketLocation(FName("Muzzle"));
+	FVector End = Hero->GetCameraBoom()->GetComponentLocation() + Hero->GetFollowCamera()->GetForwardVector() * Range;
+	FRotator Rotation = UKismetMathLibrary::FindLookAtRotation(Start, End);
+
+	FTransform MuzzleTransform = Hero->GetGunComponent()->GetSocketTransform(FName("Muzzle"));
+	MuzzleTransform.SetRotation(Rotation.Quaternion());
+	MuzzleTransform.SetScale3D(FVector(1.0f));
+
+	AGDProjectile* Projectile = GetWorld()->SpawnActorDeferred<AGDProjectile>(ProjectileClass, MuzzleTransform, GetOwningActorFromActorInfo(),
+		Hero, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (!Projectile)
+	{
+		return;
+	}
+
+	Projectile->Range = Range;
+
+	if (bSpawnPredictedProjectile)
+	{
+		// No damage on the predicted projectile, the Server's projectile applies it
+		Projectile->InitPredictedProjectile(PredictionId);
+		Projectile->PredictedImpactCueTag = ImpactCueTag;
+		CurrentActivationInfo.GetActivationPredictionKey().NewRejectedDelegate().BindUObject(Projectile, &AGDProjectile::OnPredictionRejected);
+	}
+	else
+	{
+		FGameplayEffectSpecHandle DamageEffectSpecHandle = MakeCachedOutgoingGameplayEffectSpec(DamageGameplayEffect, GetAbilityLevel());
+
+		// Pass the damage to the Damage Execution Calculation through a SetByCaller value on the GameplayEffectSpec
+		DamageEffectSpecHandle.Data.Get()->SetSetByCallerMagnitude(FGameplayTag::RequestGameplayTag(FName("Data.Damage")), Damage);
 
-		AGDProjectile* Projectile = GetWorld()->SpawnActorDeferred<AGDProjectile>(ProjectileClass, MuzzleTransform, GetOwningActorFromActorInfo(),
-			Hero, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
 		Projectile->DamageEffectSpecHandle = DamageEffectSpecHandle;
-		Projectile->Range = Range;
-		Projectile->FinishSpawning(MuzzleTransform);
+		Projectile->PredictionId = PredictionId;
 	}
+
+	Projectile->FinishSpawning(MuzzleTransform);
+}
+
+void UGDGA_FireGun::OnHitscanTraceComplete(const FHitResult& Hit, FGameplayEffectSpecHandle DamageEffectSpecHandle)
+{
+	AGDCharacterBase* HitCharacter = Cast<AGDCharacterBase>(Hit.GetActor());
+	if (!Hit.bBlockingHit || !HitCharacter || !HitCharacter->IsAlive() || !DamageEffectSpecHandle.IsValid())
+	{
+		return;
+	}
+
+	// The trace can finish after the ability ended, everything needed is in the spec
+	DamageEffectSpecHandle.Data->GetContext().AddHitResult(Hit, true);
+	UGDBlueprintLibrary::ApplyGameplayEffectSpecToActor(DamageEffectSpecHandle, HitCharacter);
 }
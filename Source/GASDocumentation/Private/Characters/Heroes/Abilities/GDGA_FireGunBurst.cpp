@@ -0,0 +1,9 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDGA_FireGunBurst.h"
+
+UGDGA_FireGunBurst::UGDGA_FireGunBurst()
+{
+	ShotsPerActivation = 3;
+}
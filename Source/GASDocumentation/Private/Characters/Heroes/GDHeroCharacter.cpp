@@ -7,8 +7,10 @@
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/DecalComponent.h"
+#include "Engine/AssetManager.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "GASDocumentationGameMode.h"
+#include "GASDocumentation.h"
 #include "GDAbilitySystemComponent.h"
 #include "GDPlayerController.h"
 #include "GDPlayerState.h"
@@ -18,6 +20,22 @@
 #include "UObject/ConstructorHelpers.h"
 #include "WidgetComponent.h"
 #include "GDThrowableProjectile.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Projectile Shot Delay (ms)"), STAT_GDProjectileShotDelay, STATGROUP_GASDocumentation);
+
+static FAutoConsoleCommandWithWorld CVarGDProjectileShotDelay(
+	TEXT("GD.Projectile.ShotDelay"),
+	TEXT("Logs the time from the local hero's fire events to its projectiles becoming visible. Use with Net PktLag to compare predicted and Server only projectiles."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		APlayerController* PC = World ? World->GetFirstPlayerController() : nullptr;
+		AGDHeroCharacter* Hero = PC ? Cast<AGDHeroCharacter>(PC->GetPawn()) : nullptr;
+		if (Hero)
+		{
+			Hero->LogProjectileShotDelay();
+		}
+	}));
 
 AGDHeroCharacter::AGDHeroCharacter(const class FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
@@ -46,15 +64,16 @@ AGDHeroCharacter::AGDHeroCharacter(const class FObjectInitializer& ObjectInitial
 	UIFloatingStatusBarComponent->SetWidgetSpace(EWidgetSpace::Screen);
 	UIFloatingStatusBarComponent->SetDrawSize(FVector2D(500, 500));
 
-	UIFloatingStatusBarClass = StaticLoadClass(UObject::StaticClass(), nullptr, TEXT("/Game/GASDocumentation/UI/UI_FloatingStatusBar_Hero.UI_FloatingStatusBar_Hero_C"));
-	if (!UIFloatingStatusBarClass)
-	{
-		UE_LOG(LogTemp, Error, TEXT("%s() Failed to find UIFloatingStatusBarClass. If it was moved, please update the reference location in C++."), TEXT(__FUNCTION__));
-	}
+	// Preloaded by the GDAssetPreloadSubsystem during map load, otherwise loaded asynchronously in InitializeFloatingStatusBar()
+	UIFloatingStatusBarClass = TSoftClassPtr<UGDFloatingStatusBarWidget>(FSoftObjectPath(TEXT("/Game/GASDocumentation/UI/UI_FloatingStatusBar_Hero.UI_FloatingStatusBar_Hero_C")));
 
 	AIControllerClass = AGDHeroAIController::StaticClass();
 
 	DeadTag = FGameplayTag::RequestGameplayTag(FName("State.Dead"));
+
+	NumMeasuredProjectileShots = 0;
+	TotalProjectileShotDelay = 0.0;
+	LastProjectileShotDelay = 0.0;
 }
 
 // Called to bind functionality to input
@@ -236,6 +255,70 @@ void AGDHeroCharacter::FinishDying()
 	Super::FinishDying();
 }
 
+void AGDHeroCharacter::RegisterPredictedProjectile(AGDProjectile* Projectile)
+{
+	if (Projectile)
+	{
+		PredictedProjectiles.Add(Projectile->PredictionId, Projectile);
+	}
+}
+
+AGDProjectile* AGDHeroCharacter::TakePredictedProjectile(int32 PredictionId)
+{
+	TWeakObjectPtr<AGDProjectile> Projectile;
+	PredictedProjectiles.RemoveAndCopyValue(PredictionId, Projectile);
+	return Projectile.Get();
+}
+
+void AGDHeroCharacter::UnregisterPredictedProjectile(AGDProjectile* Projectile)
+{
+	// Only remove the entry if it is still this projectile and not one that reused the PredictionId
+	TWeakObjectPtr<AGDProjectile>* RegisteredProjectile = Projectile ? PredictedProjectiles.Find(Projectile->PredictionId) : nullptr;
+	if (RegisteredProjectile && (!RegisteredProjectile->IsValid() || RegisteredProjectile->Get() == Projectile))
+	{
+		PredictedProjectiles.Remove(Projectile->PredictionId);
+	}
+}
+
+void AGDHeroCharacter::NotifyProjectileShotFired(int32 PredictionId)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	// Shots whose projectile never showed up, like rejected activations, are dropped after a while
+	for (auto It = PendingProjectileShotTimes.CreateIterator(); It; ++It)
+	{
+		if (Now - It.Value() > 5.0)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	PendingProjectileShotTimes.Add(PredictionId, Now);
+}
+
+void AGDHeroCharacter::NotifyProjectileShotVisible(int32 PredictionId)
+{
+	double ShotTime = 0.0;
+	if (!PendingProjectileShotTimes.RemoveAndCopyValue(PredictionId, ShotTime))
+	{
+		return;
+	}
+
+	LastProjectileShotDelay = FPlatformTime::Seconds() - ShotTime;
+	TotalProjectileShotDelay += LastProjectileShotDelay;
+	NumMeasuredProjectileShots++;
+
+	SET_FLOAT_STAT(STAT_GDProjectileShotDelay, LastProjectileShotDelay * 1000.0);
+}
+
+void AGDHeroCharacter::LogProjectileShotDelay() const
+{
+	const double AverageDelay = NumMeasuredProjectileShots > 0 ? TotalProjectileShotDelay / NumMeasuredProjectileShots : 0.0;
+
+	UE_LOG(LogTemp, Log, TEXT("%s() %s: %d shots, last %.1f ms, average %.1f ms, %d predicted projectiles awaiting the Server"), TEXT(__FUNCTION__), *GetName(),
+		NumMeasuredProjectileShots, LastProjectileShotDelay * 1000.0, AverageDelay * 1000.0, PredictedProjectiles.Num());
+}
+
 /**
 * On the Server, Possession happens before BeginPlay.
 * On the Client, BeginPlay happens before Possession.
@@ -310,17 +393,27 @@ void AGDHeroCharacter::InitializeFloatingStatusBar()
 	AGDPlayerController* PC = Cast<AGDPlayerController>(UGameplayStatics::GetPlayerController(GetWorld(), 0));
 	if (PC && PC->IsLocalPlayerController())
 	{
-		if (UIFloatingStatusBarClass)
+		UClass* StatusBarClass = UIFloatingStatusBarClass.Get();
+		if (!StatusBarClass)
 		{
-			UIFloatingStatusBar = CreateWidget<UGDFloatingStatusBarWidget>(PC, UIFloatingStatusBarClass);
-			if (UIFloatingStatusBar && UIFloatingStatusBarComponent)
+			if (!UIFloatingStatusBarClass.IsNull())
 			{
-				UIFloatingStatusBarComponent->SetWidget(UIFloatingStatusBar);
-
-				// Setup the floating status bar
-				UIFloatingStatusBar->SetHealthPercentage(GetHealth() / GetMaxHealth());
-				UIFloatingStatusBar->SetManaPercentage(GetMana() / GetMaxMana());
+				// Preload hasn't finished yet. Create the widget when the class finishes loading instead of hitching here.
+				UAssetManager::GetStreamableManager().RequestAsyncLoad(UIFloatingStatusBarClass.ToSoftObjectPath(),
+					FStreamableDelegate::CreateUObject(this, &AGDHeroCharacter::InitializeFloatingStatusBar));
 			}
+
+			return;
+		}
+
+		UIFloatingStatusBar = CreateWidget<UGDFloatingStatusBarWidget>(PC, StatusBarClass);
+		if (UIFloatingStatusBar && UIFloatingStatusBarComponent)
+		{
+			UIFloatingStatusBarComponent->SetWidget(UIFloatingStatusBar);
+
+			// Setup the floating status bar
+			UIFloatingStatusBar->SetHealthPercentage(GetHealth() / GetMaxHealth());
+			UIFloatingStatusBar->SetManaPercentage(GetMana() / GetMaxMana());
 		}
 	}
 }
@@ -0,0 +1,354 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDMassMinionCharacter.h"
+#include "Engine/GameInstance.h"
+#include "GameplayEffectExtension.h"
+#include "GDCombatEventSubsystem.h"
+#include "GDAbilitySystemComponent.h"
+#include "GDAttributeSetBase.h"
+#include "GDFloatingStatusBarWidget.h"
+#include "GDPlayerController.h"
+#include "UnrealNetwork.h"
+
+AGDMassMinionCharacter::AGDMassMinionCharacter(const class FObjectInitializer& ObjectInitializer) :
+	Super(ObjectInitializer.DoNotCreateDefaultSubobject(TEXT("AbilitySystemComponent")).DoNotCreateDefaultSubobject(TEXT("AttributeSetBase")))
+{
+	MassHealth = 0.0f;
+	MassMaxHealth = 0.0f;
+	MassMoveSpeed = 0.0f;
+	MassMinionIndex = INDEX_NONE;
+}
+
+void AGDMassMinionCharacter::InitializeAbilitySystem()
+{
+	// Promoted minions initialize exactly like full minions
+	if (AbilitySystemComponent)
+	{
+		Super::InitializeAbilitySystem();
+		return;
+	}
+
+	// Only initialize once
+	if (AbilitySystemInitialized)
+	{
+		return;
+	}
+
+	AbilitySystemInitialized = true;
+
+	FGDMassMinionAttributes Attributes = ResolveDefaultMassAttributes();
+	MassMoveSpeed = Attributes.MoveSpeed;
+
+	if (Role == ROLE_Authority)
+	{
+		MassHealth = Attributes.Health;
+		MassMaxHealth = Attributes.MaxHealth;
+
+		UGDMassMinionSubsystem* Subsystem = GetMassMinionSubsystem();
+		if (Subsystem)
+		{
+			MassMinionIndex = Subsystem->RegisterMinion(this, Attributes);
+		}
+	}
+
+	InitializeFloatingStatusBar();
+}
+
+bool AGDMassMinionCharacter::PromoteToAbilitySystem()
+{
+	if (AbilitySystemComponent)
+	{
+		return true;
+	}
+
+	if (Role != ROLE_Authority || !IsAlive())
+	{
+		return false;
+	}
+
+	const float CarriedHealth = MassHealth;
+
+	UGDMassMinionSubsystem* Subsystem = GetMassMinionSubsystem();
+	if (Subsystem)
+	{
+		Subsystem->UnregisterMinion(MassMinionIndex);
+	}
+
+	MassMinionIndex = INDEX_NONE;
+
+	PromotedAbilitySystemComponent = NewObject<UGDAbilitySystemComponent>(this, TEXT("AbilitySystemComponent"));
+	PromotedAbilitySystemComponent->SetIsReplicated(true);
+	PromotedAbilitySystemComponent->SetReplicationMode(EGameplayEffectReplicationMode::Minimal);
+	PromotedAbilitySystemComponent->RegisterComponent();
+
+	// The AbilitySystemComponent replicates its spawned AttributeSets as subobjects
+	PromotedAttributeSetBase = NewObject<UGDAttributeSetBase>(this, TEXT("AttributeSetBase"));
+	PromotedAbilitySystemComponent->GetSpawnedAttributes_Mutable().AddUnique(PromotedAttributeSetBase);
+
+	OnRep_PromotedAbilitySystem();
+
+	// InitializeAttributes() reset Health to the DefaultAttributes value
+	SetHealth(CarriedHealth);
+
+	return true;
+}
+
+bool AGDMassMinionCharacter::IsPromoted() const
+{
+	return AbilitySystemComponent != nullptr;
+}
+
+int32 AGDMassMinionCharacter::GetMassMinionIndex() const
+{
+	return MassMinionIndex;
+}
+
+void AGDMassMinionCharacter::MassDamageReceived(const FGameplayEffectSpec& Spec, float DamageDone, float NewHealth, bool bWasAlive)
+{
+	MassHealth = NewHealth;
+	OnRep_MassHealth();
+
+	if (!bWasAlive)
+	{
+		return;
+	}
+
+	// Same source resolution as GDAttributeSetBase::PostGameplayEffectExecute()
+	FGameplayEffectContextHandle Context = Spec.GetContext();
+	UAbilitySystemComponent* Source = Context.GetOriginalInstigatorAbilitySystemComponent();
+
+	AActor* SourceActor = nullptr;
+	AController* SourceController = nullptr;
+	AGDCharacterBase* SourceCharacter = nullptr;
+	if (Source && Source->AbilityActorInfo.IsValid() && Source->AbilityActorInfo->AvatarActor.IsValid())
+	{
+		SourceActor = Source->AbilityActorInfo->AvatarActor.Get();
+		SourceController = Source->AbilityActorInfo->PlayerController.Get();
+		if (SourceController == nullptr && SourceActor != nullptr)
+		{
+			if (APawn* Pawn = Cast<APawn>(SourceActor))
+			{
+				SourceController = Pawn->GetController();
+			}
+		}
+
+		if (SourceController)
+		{
+			SourceCharacter = Cast<AGDCharacterBase>(SourceController->GetPawn());
+		}
+		else
+		{
+			SourceCharacter = Cast<AGDCharacterBase>(SourceActor);
+		}
+
+		if (Context.GetEffectCauser())
+		{
+			SourceActor = Context.GetEffectCauser();
+		}
+	}
+
+	// Play HitReact animation and sound with a multicast RPC. No hit result defaults to front.
+	EGDHitReactDirection HitDirection = Context.GetHitResult() ? GetHitReactDirection(Context.GetHitResult()->Location) : EGDHitReactDirection::Front;
+	switch (HitDirection)
+	{
+	case EGDHitReactDirection::Left:
+		PlayHitReact(HitDirectionLeftTag, SourceCharacter);
+		break;
+	case EGDHitReactDirection::Right:
+		PlayHitReact(HitDirectionRightTag, SourceCharacter);
+		break;
+	case EGDHitReactDirection::Back:
+		PlayHitReact(HitDirectionBackTag, SourceCharacter);
+		break;
+	default:
+		PlayHitReact(HitDirectionFrontTag, SourceCharacter);
+		break;
+	}
+
+	UGDCombatEventSubsystem::Record(EGDCombatEventType::Damage, SourceCharacter, this, DamageDone);
+	UGDCombatEventSubsystem::Record(EGDCombatEventType::HitReact, SourceCharacter, this, static_cast<float>(HitDirection));
+
+	// Show damage number for the Source player unless it was self damage
+	if (SourceActor != this)
+	{
+		AGDPlayerController* PC = Cast<AGDPlayerController>(SourceController);
+		if (PC)
+		{
+			PC->ShowDamageNumber(DamageDone, this);
+		}
+	}
+
+	if (!IsAlive())
+	{
+		// Give XP and Gold bounties to Source
+		UGDMassMinionSubsystem* Subsystem = GetMassMinionSubsystem();
+		if (Source && Subsystem && Subsystem->GetAttributeTable().IsValidIndex(MassMinionIndex))
+		{
+			const FGDMassMinionAttributes Attributes = Subsystem->GetAttributeTable().Get(MassMinionIndex);
+
+			// Create a dynamic instant Gameplay Effect to give the bounties
+			UGameplayEffect* GEBounty = NewObject<UGameplayEffect>(GetTransientPackage(), FName(TEXT("Bounty")));
+			GEBounty->DurationPolicy = EGameplayEffectDurationType::Instant;
+
+			int32 Idx = GEBounty->Modifiers.Num();
+			GEBounty->Modifiers.SetNum(Idx + 2);
+
+			FGameplayModifierInfo& InfoXP = GEBounty->Modifiers[Idx];
+			InfoXP.ModifierMagnitude = FScalableFloat(Attributes.XPBounty);
+			InfoXP.ModifierOp = EGameplayModOp::Additive;
+			InfoXP.Attribute = UGDAttributeSetBase::GetXPAttribute();
+
+			FGameplayModifierInfo& InfoGold = GEBounty->Modifiers[Idx + 1];
+			InfoGold.ModifierMagnitude = FScalableFloat(Attributes.GoldBounty);
+			InfoGold.ModifierOp = EGameplayModOp::Additive;
+			InfoGold.Attribute = UGDAttributeSetBase::GetGoldAttribute();
+
+			Source->ApplyGameplayEffectToSelf(GEBounty, 1.0f, Source->MakeEffectContext());
+
+			UGDCombatEventSubsystem::Record(EGDCombatEventType::Bounty, SourceCharacter, this, Attributes.XPBounty, Attributes.GoldBounty);
+		}
+
+		Die();
+	}
+}
+
+float AGDMassMinionCharacter::GetHealth() const
+{
+	if (AbilitySystemComponent)
+	{
+		return Super::GetHealth();
+	}
+
+	return MassHealth;
+}
+
+float AGDMassMinionCharacter::GetMaxHealth() const
+{
+	if (AbilitySystemComponent)
+	{
+		return Super::GetMaxHealth();
+	}
+
+	return MassMaxHealth;
+}
+
+float AGDMassMinionCharacter::GetMoveSpeed() const
+{
+	if (AbilitySystemComponent)
+	{
+		return Super::GetMoveSpeed();
+	}
+
+	return MassMoveSpeed;
+}
+
+void AGDMassMinionCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AGDMassMinionCharacter, MassHealth);
+	DOREPLIFETIME(AGDMassMinionCharacter, MassMaxHealth);
+	DOREPLIFETIME(AGDMassMinionCharacter, PromotedAbilitySystemComponent);
+	DOREPLIFETIME(AGDMassMinionCharacter, PromotedAttributeSetBase);
+}
+
+void AGDMassMinionCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UGDMassMinionSubsystem* Subsystem = GetMassMinionSubsystem();
+	if (Subsystem && MassMinionIndex != INDEX_NONE)
+	{
+		Subsystem->UnregisterMinion(MassMinionIndex);
+		MassMinionIndex = INDEX_NONE;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+FGDMassMinionAttributes AGDMassMinionCharacter::ResolveDefaultMassAttributes() const
+{
+	FGDMassMinionAttributes Attributes = DefaultMassAttributes;
+	bool bHealthOverridden = false;
+
+	if (DefaultAttributes)
+	{
+		for (const FGameplayModifierInfo& Modifier : DefaultAttributes.GetDefaultObject()->Modifiers)
+		{
+			float Magnitude = 0.0f;
+			if (Modifier.ModifierOp != EGameplayModOp::Override || !Modifier.ModifierMagnitude.GetStaticMagnitudeIfPossible(1.0f, Magnitude))
+			{
+				continue;
+			}
+
+			if (Modifier.Attribute == UGDAttributeSetBase::GetHealthAttribute())
+			{
+				Attributes.Health = Magnitude;
+				bHealthOverridden = true;
+			}
+			else if (Modifier.Attribute == UGDAttributeSetBase::GetMaxHealthAttribute())
+			{
+				Attributes.MaxHealth = Magnitude;
+			}
+			else if (Modifier.Attribute == UGDAttributeSetBase::GetArmorAttribute())
+			{
+				Attributes.Armor = Magnitude;
+			}
+			else if (Modifier.Attribute == UGDAttributeSetBase::GetMoveSpeedAttribute())
+			{
+				Attributes.MoveSpeed = Magnitude;
+			}
+			else if (Modifier.Attribute == UGDAttributeSetBase::GetXPBountyAttribute())
+			{
+				Attributes.XPBounty = Magnitude;
+			}
+			else if (Modifier.Attribute == UGDAttributeSetBase::GetGoldBountyAttribute())
+			{
+				Attributes.GoldBounty = Magnitude;
+			}
+		}
+	}
+
+	if (!bHealthOverridden)
+	{
+		Attributes.Health = Attributes.MaxHealth;
+	}
+
+	// Same clamps as GDAttributeSetBase
+	Attributes.Health = FMath::Clamp(Attributes.Health, 0.0f, Attributes.MaxHealth);
+	Attributes.MoveSpeed = FMath::Clamp<float>(Attributes.MoveSpeed, 150, 1000);
+
+	return Attributes;
+}
+
+void AGDMassMinionCharacter::OnRep_MassHealth()
+{
+	// Update floating status bar
+	if (UIFloatingStatusBar && MassMaxHealth > 0.0f)
+	{
+		UIFloatingStatusBar->SetHealthPercentage(MassHealth / MassMaxHealth);
+	}
+}
+
+void AGDMassMinionCharacter::OnRep_PromotedAbilitySystem()
+{
+	// Wait until both have replicated. Only promote once.
+	if (!PromotedAbilitySystemComponent || !PromotedAttributeSetBase || AbilitySystemComponent)
+	{
+		return;
+	}
+
+	HardRefAbilitySystemComponent = PromotedAbilitySystemComponent;
+	AbilitySystemComponent = PromotedAbilitySystemComponent;
+	HardRefAttributeSetBase = PromotedAttributeSetBase;
+	AttributeSetBase = PromotedAttributeSetBase;
+
+	// Run the full minion initialization now that there is an AbilitySystemComponent
+	AbilitySystemInitialized = false;
+	Super::InitializeAbilitySystem();
+}
+
+UGDMassMinionSubsystem* AGDMassMinionCharacter::GetMassMinionSubsystem() const
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	return GameInstance ? GameInstance->GetSubsystem<UGDMassMinionSubsystem>() : nullptr;
+}
@@ -0,0 +1,375 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDMassMinionSubsystem.h"
+#include "CoreGlobals.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GASDocumentation.h"
+#include "GDCombatRules.h"
+#include "GDDamageExecCalculation.h"
+#include "GDMassMinionCharacter.h"
+#include "GDMinionCharacter.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Kismet/GameplayStatics.h"
+#include "UObject/UObjectArray.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("MassMinion Count"), STAT_GDMassMinionCount, STATGROUP_GASDocumentation);
+DECLARE_MEMORY_STAT(TEXT("MassMinion Attribute Table"), STAT_GDMassMinionTableMemory, STATGROUP_GASDocumentation);
+DECLARE_CYCLE_STAT(TEXT("MassMinion ApplyDamage"), STAT_GDMassMinionApplyDamage, STATGROUP_GASDocumentation);
+
+static FAutoConsoleCommandWithWorldAndArgs CVarGDMassMinionBenchmark(
+	TEXT("GD.MassMinion.Benchmark"),
+	TEXT("Spawns N (default 1000) full minions and then N mass minions and logs the memory and game thread cost of each. Server only."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		UGDMassMinionSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UGDMassMinionSubsystem>() : nullptr;
+		if (Subsystem)
+		{
+			Subsystem->StartBenchmark(World, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000);
+		}
+	}));
+
+int32 FGDMassMinionAttributeTable::Add(AGDMassMinionCharacter* Minion, const FGDMassMinionAttributes& Attributes)
+{
+	int32 Index;
+	if (FreeIndices.Num() > 0)
+	{
+		Index = FreeIndices.Pop(false);
+	}
+	else
+	{
+		Index = Minions.Num();
+		Health.AddUninitialized();
+		MaxHealth.AddUninitialized();
+		Armor.AddUninitialized();
+		MoveSpeed.AddUninitialized();
+		XPBounty.AddUninitialized();
+		GoldBounty.AddUninitialized();
+		Minions.AddDefaulted();
+	}
+
+	Health[Index] = Attributes.Health;
+	MaxHealth[Index] = Attributes.MaxHealth;
+	Armor[Index] = Attributes.Armor;
+	MoveSpeed[Index] = Attributes.MoveSpeed;
+	XPBounty[Index] = Attributes.XPBounty;
+	GoldBounty[Index] = Attributes.GoldBounty;
+	Minions[Index] = Minion;
+
+	return Index;
+}
+
+void FGDMassMinionAttributeTable::Remove(int32 Index)
+{
+	if (!IsValidIndex(Index))
+	{
+		return;
+	}
+
+	Minions[Index] = nullptr;
+	Health[Index] = 0.0f;
+	FreeIndices.Add(Index);
+}
+
+bool FGDMassMinionAttributeTable::IsValidIndex(int32 Index) const
+{
+	// Explicitly cleared rows are free. Rows whose minion was garbage collected without EndPlay are still valid until removed.
+	return Minions.IsValidIndex(Index) && !Minions[Index].IsExplicitlyNull();
+}
+
+FGDMassMinionAttributes FGDMassMinionAttributeTable::Get(int32 Index) const
+{
+	FGDMassMinionAttributes Attributes;
+	Attributes.Health = Health[Index];
+	Attributes.MaxHealth = MaxHealth[Index];
+	Attributes.Armor = Armor[Index];
+	Attributes.MoveSpeed = MoveSpeed[Index];
+	Attributes.XPBounty = XPBounty[Index];
+	Attributes.GoldBounty = GoldBounty[Index];
+	return Attributes;
+}
+
+int32 FGDMassMinionAttributeTable::Num() const
+{
+	return Minions.Num() - FreeIndices.Num();
+}
+
+SIZE_T FGDMassMinionAttributeTable::GetAllocatedSize() const
+{
+	return Health.GetAllocatedSize() + MaxHealth.GetAllocatedSize() + Armor.GetAllocatedSize() + MoveSpeed.GetAllocatedSize()
+		+ XPBounty.GetAllocatedSize() + GoldBounty.GetAllocatedSize() + Minions.GetAllocatedSize() + FreeIndices.GetAllocatedSize();
+}
+
+UGDMassMinionSubsystem::UGDMassMinionSubsystem()
+{
+	BenchmarkFullMinionClass = TSoftClassPtr<AGDMinionCharacter>(FSoftObjectPath(TEXT("/Game/GASDocumentation/Characters/Minions/RedMinion/BP_RedMinion.BP_RedMinion_C")));
+	BenchmarkMassMinionClass = TSoftClassPtr<AGDMinionCharacter>(FSoftObjectPath(AGDMassMinionCharacter::StaticClass()));
+	BenchmarkFrames = 120;
+
+	BenchmarkPhase = EBenchmarkPhase::None;
+	BenchmarkNumMinions = 0;
+	BenchmarkFramesSampled = 0;
+}
+
+int32 UGDMassMinionSubsystem::RegisterMinion(AGDMassMinionCharacter* Minion, const FGDMassMinionAttributes& Attributes)
+{
+	const int32 Index = AttributeTable.Add(Minion, Attributes);
+
+	SET_DWORD_STAT(STAT_GDMassMinionCount, AttributeTable.Num());
+	SET_MEMORY_STAT(STAT_GDMassMinionTableMemory, AttributeTable.GetAllocatedSize());
+
+	return Index;
+}
+
+void UGDMassMinionSubsystem::UnregisterMinion(int32 MassMinionIndex)
+{
+	AttributeTable.Remove(MassMinionIndex);
+
+	SET_DWORD_STAT(STAT_GDMassMinionCount, AttributeTable.Num());
+}
+
+const FGDMassMinionAttributeTable& UGDMassMinionSubsystem::GetAttributeTable() const
+{
+	return AttributeTable;
+}
+
+bool UGDMassMinionSubsystem::IsSupportedEffectSpec(const FGameplayEffectSpec& Spec)
+{
+	if (!DamageTag.IsValid())
+	{
+		DamageTag = FGameplayTag::RequestGameplayTag(FName("Data.Damage"));
+	}
+
+	// Mass minions have no active effects, so duration and periodic damage would only ever apply once
+	const bool bInstant = Spec.Def && Spec.Def->DurationPolicy == EGameplayEffectDurationType::Instant;
+	if (bInstant && Spec.SetByCallerTagMagnitudes.Contains(DamageTag))
+	{
+		return true;
+	}
+
+	bool bAlreadyReported = false;
+	UnsupportedEffects.Add(Spec.Def, &bAlreadyReported);
+	if (!bAlreadyReported)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s() %s isn't instant or has no SetByCaller Data.Damage and can't be applied to mass minions. Only instant damage is supported."),
+			TEXT(__FUNCTION__), *GetNameSafe(Spec.Def));
+	}
+
+	return false;
+}
+
+float UGDMassMinionSubsystem::ApplyDamageEffectSpec(int32 MassMinionIndex, const FGameplayEffectSpec& Spec)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GDMassMinionApplyDamage);
+
+	if (!AttributeTable.IsValidIndex(MassMinionIndex) || !IsSupportedEffectSpec(Spec))
+	{
+		return 0.0f;
+	}
+
+	// Same inputs as GDDamageExecCalculation. The minion's Armor comes from the table instead of a captured attribute.
+	const float UnmitigatedDamage = FMath::Max<float>(Spec.GetSetByCallerMagnitude(DamageTag, false, -1.0f), 0.0f);
+	const float MitigatedDamage = UGDDamageExecCalculation::CalculateMitigatedDamage(UnmitigatedDamage, FMath::Max<float>(AttributeTable.Armor[MassMinionIndex], 0.0f));
+	if (MitigatedDamage <= 0.0f)
+	{
+		return 0.0f;
+	}
+
+	ApplyMitigatedDamage(MassMinionIndex, Spec, MitigatedDamage);
+
+	return MitigatedDamage;
+}
+
+void UGDMassMinionSubsystem::ApplyMitigatedDamage(int32 MassMinionIndex, const FGameplayEffectSpec& Spec, float MitigatedDamage)
+{
+	if (!AttributeTable.IsValidIndex(MassMinionIndex) || MitigatedDamage <= 0.0f)
+	{
+		return;
+	}
+
+	float& Health = AttributeTable.Health[MassMinionIndex];
+	const FGDDamageOutcome Outcome = FGDCombatRules::ApplyDamage(Health, AttributeTable.MaxHealth[MassMinionIndex], MitigatedDamage, false);
+	Health = Outcome.NewHealth;
+
+	AGDMassMinionCharacter* Minion = AttributeTable.Minions[MassMinionIndex].Get();
+	if (Minion)
+	{
+		Minion->MassDamageReceived(Spec, MitigatedDamage, Health, Outcome.bWasAlive);
+	}
+}
+
+int32 UGDMassMinionSubsystem::GetNumMassMinions() const
+{
+	return AttributeTable.Num();
+}
+
+void UGDMassMinionSubsystem::StartBenchmark(UWorld* World, int32 NumMinions)
+{
+	if (!World || World->GetNetMode() == NM_Client || BenchmarkPhase != EBenchmarkPhase::None)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s() Benchmark can only run on the Server and only one at a time."), TEXT(__FUNCTION__));
+		return;
+	}
+
+	BenchmarkWorld = World;
+	BenchmarkNumMinions = FMath::Max(NumMinions, 1);
+	BenchmarkFrames = FMath::Max(BenchmarkFrames, 1);
+	BenchmarkFramesSampled = 0;
+	BenchmarkSamples[0] = FBenchmarkSample();
+	BenchmarkSamples[1] = FBenchmarkSample();
+	BenchmarkSamples[2] = FBenchmarkSample();
+	BenchmarkPhase = EBenchmarkPhase::Baseline;
+
+	UE_LOG(LogTemp, Log, TEXT("%s() Benchmarking %d minions over %d frames per representation."), TEXT(__FUNCTION__), BenchmarkNumMinions, BenchmarkFrames);
+}
+
+void UGDMassMinionSubsystem::Deinitialize()
+{
+	DestroyBenchmarkMinions();
+	BenchmarkPhase = EBenchmarkPhase::None;
+
+	Super::Deinitialize();
+}
+
+void UGDMassMinionSubsystem::Tick(float DeltaTime)
+{
+	if (!BenchmarkWorld.IsValid())
+	{
+		DestroyBenchmarkMinions();
+		BenchmarkPhase = EBenchmarkPhase::None;
+		return;
+	}
+
+	// GGameThreadTime is the previous frame's game thread time, so skip the frame that spawned the minions
+	FBenchmarkSample& Sample = BenchmarkSamples[static_cast<int32>(BenchmarkPhase) - 1];
+	if (BenchmarkFramesSampled > 0)
+	{
+		Sample.GameThreadMilliseconds += FPlatformTime::ToMilliseconds(GGameThreadTime);
+	}
+
+	if (++BenchmarkFramesSampled <= BenchmarkFrames)
+	{
+		return;
+	}
+
+	// Memory is sampled at the end of the window so that the previous representation has been garbage collected
+	Sample.GameThreadMilliseconds /= BenchmarkFrames;
+	Sample.UsedPhysicalMemory = FPlatformMemory::GetStats().UsedPhysical;
+	Sample.NumObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+	BenchmarkFramesSampled = 0;
+
+	switch (BenchmarkPhase)
+	{
+	case EBenchmarkPhase::Baseline:
+		BenchmarkPhase = EBenchmarkPhase::Full;
+		SpawnBenchmarkMinions(BenchmarkFullMinionClass, BenchmarkSamples[1]);
+		break;
+	case EBenchmarkPhase::Full:
+		DestroyBenchmarkMinions();
+
+		// Collect the destroyed minions before the mass minions are measured
+		GEngine->ForceGarbageCollection(true);
+
+		BenchmarkPhase = EBenchmarkPhase::Mass;
+		SpawnBenchmarkMinions(BenchmarkMassMinionClass, BenchmarkSamples[2]);
+		break;
+	default:
+		LogBenchmarkResults();
+		DestroyBenchmarkMinions();
+		BenchmarkPhase = EBenchmarkPhase::None;
+		break;
+	}
+}
+
+bool UGDMassMinionSubsystem::IsTickable() const
+{
+	return !HasAnyFlags(RF_ClassDefaultObject) && BenchmarkPhase != EBenchmarkPhase::None;
+}
+
+TStatId UGDMassMinionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGDMassMinionSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UGDMassMinionSubsystem::GetTickableGameObjectWorld() const
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	return GameInstance ? GameInstance->GetWorld() : nullptr;
+}
+
+void UGDMassMinionSubsystem::SpawnBenchmarkMinions(TSoftClassPtr<AGDMinionCharacter> MinionClass, FBenchmarkSample& Sample)
+{
+	UWorld* World = BenchmarkWorld.Get();
+
+	// The benchmark measures steady state cost so a synchronous load is fine here
+	UClass* LoadedClass = MinionClass.LoadSynchronous();
+	if (!World || !LoadedClass)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s() Failed to load minion class %s."), TEXT(__FUNCTION__), *MinionClass.ToString());
+		return;
+	}
+
+	// Spread the minions out in a grid in front of the first player so that they are relevant and rendered
+	FVector Origin = FVector::ZeroVector;
+	APawn* PlayerPawn = UGameplayStatics::GetPlayerPawn(World, 0);
+	if (PlayerPawn)
+	{
+		Origin = PlayerPawn->GetActorLocation() + PlayerPawn->GetActorForwardVector() * 500.0f;
+	}
+
+	const int32 GridSize = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(BenchmarkNumMinions)));
+	const double StartTime = FPlatformTime::Seconds();
+
+	for (int32 i = 0; i < BenchmarkNumMinions; i++)
+	{
+		const FTransform SpawnTransform(FVector(Origin.X + (i % GridSize) * 150.0f, Origin.Y + (i / GridSize) * 150.0f, Origin.Z));
+
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		AGDMinionCharacter* Minion = World->SpawnActor<AGDMinionCharacter>(LoadedClass, SpawnTransform, SpawnParameters);
+		if (Minion)
+		{
+			BenchmarkActors.Add(Minion);
+		}
+	}
+
+	Sample.SpawnSeconds = FPlatformTime::Seconds() - StartTime;
+}
+
+void UGDMassMinionSubsystem::DestroyBenchmarkMinions()
+{
+	for (TWeakObjectPtr<AActor>& Actor : BenchmarkActors)
+	{
+		if (Actor.IsValid())
+		{
+			Actor->Destroy();
+		}
+	}
+
+	BenchmarkActors.Empty();
+}
+
+void UGDMassMinionSubsystem::LogBenchmarkResults() const
+{
+	const FBenchmarkSample& Baseline = BenchmarkSamples[0];
+
+	auto LogSample = [this, &Baseline](const TCHAR* Name, const FBenchmarkSample& Sample)
+	{
+		const double MemoryDeltaMB = (static_cast<double>(Sample.UsedPhysicalMemory) - static_cast<double>(Baseline.UsedPhysicalMemory)) / (1024.0 * 1024.0);
+
+		UE_LOG(LogTemp, Log, TEXT("  %s: Spawn %.2f ms, Memory +%.2f MB (%.2f KB/minion), UObjects +%d (%.1f/minion), GameThread %.3f ms/frame (+%.3f)"),
+			Name, Sample.SpawnSeconds * 1000.0, MemoryDeltaMB, MemoryDeltaMB * 1024.0 / BenchmarkNumMinions,
+			Sample.NumObjects - Baseline.NumObjects, static_cast<float>(Sample.NumObjects - Baseline.NumObjects) / BenchmarkNumMinions,
+			Sample.GameThreadMilliseconds, Sample.GameThreadMilliseconds - Baseline.GameThreadMilliseconds);
+	};
+
+	UE_LOG(LogTemp, Log, TEXT("Mass minion benchmark, %d minions. Baseline GameThread %.3f ms/frame."), BenchmarkNumMinions, Baseline.GameThreadMilliseconds);
+	LogSample(TEXT("Full"), BenchmarkSamples[1]);
+	LogSample(TEXT("Mass"), BenchmarkSamples[2]);
+	UE_LOG(LogTemp, Log, TEXT("  Mass attribute table: %d bytes"), static_cast<int32>(AttributeTable.GetAllocatedSize()));
+}
@@ -3,20 +3,26 @@
 
 #include "GDMinionCharacter.h"
 #include "Components/CapsuleComponent.h"
+#include "Engine/AssetManager.h"
 #include "GDAbilitySystemComponent.h"
 #include "GDAttributeSetBase.h"
+#include "GDCrowdControlSubsystem.h"
 #include "GDFloatingStatusBarWidget.h"
 #include "Kismet/GameplayStatics.h"
 #include "WidgetComponent.h"
 
 AGDMinionCharacter::AGDMinionCharacter(const class FObjectInitializer& ObjectInitializer) : Super(ObjectInitializer)
 {
-	// Create ability system component, and set it to be explicitly replicated
-	HardRefAbilitySystemComponent = CreateDefaultSubobject<UGDAbilitySystemComponent>(TEXT("AbilitySystemComponent"));
-	HardRefAbilitySystemComponent->SetIsReplicated(true);
+	// Create ability system component, and set it to be explicitly replicated.
+	// Optional so that GDMassMinionCharacter can skip it with DoNotCreateDefaultSubobject.
+	HardRefAbilitySystemComponent = CreateOptionalDefaultSubobject<UGDAbilitySystemComponent>(TEXT("AbilitySystemComponent"));
+	if (HardRefAbilitySystemComponent)
+	{
+		HardRefAbilitySystemComponent->SetIsReplicated(true);
 
-	// Minimal Mode means that no GameplayEffects will replicate. They will only live on the Server. Attributes, GameplayTags, and GameplayCues will still replicate to us.
-	HardRefAbilitySystemComponent->SetReplicationMode(EGameplayEffectReplicationMode::Minimal);
+		// Minimal Mode means that no GameplayEffects will replicate. They will only live on the Server. Attributes, GameplayTags, and GameplayCues will still replicate to us.
+		HardRefAbilitySystemComponent->SetReplicationMode(EGameplayEffectReplicationMode::Minimal);
+	}
 
 	// Set our parent's TWeakObjectPtr
 	AbilitySystemComponent = HardRefAbilitySystemComponent;
@@ -24,7 +30,7 @@ AGDMinionCharacter::AGDMinionCharacter(const class FObjectInitializer& ObjectIni
 	// Create the attribute set, this replicates by default
 	// Adding it as a subobject of the owning actor of an AbilitySystemComponent
 	// automatically registers the AttributeSet with the AbilitySystemComponent
-	HardRefAttributeSetBase = CreateDefaultSubobject<UGDAttributeSetBase>(TEXT("AttributeSetBase"));
+	HardRefAttributeSetBase = CreateOptionalDefaultSubobject<UGDAttributeSetBase>(TEXT("AttributeSetBase"));
 
 	// Set our parent's TWeakObjectPtr
 	AttributeSetBase = HardRefAttributeSetBase;
@@ -37,48 +43,93 @@ AGDMinionCharacter::AGDMinionCharacter(const class FObjectInitializer& ObjectIni
 	UIFloatingStatusBarComponent->SetWidgetSpace(EWidgetSpace::Screen);
 	UIFloatingStatusBarComponent->SetDrawSize(FVector2D(500, 500));
 
-	UIFloatingStatusBarClass = StaticLoadClass(UObject::StaticClass(), nullptr, TEXT("/Game/GASDocumentation/UI/UI_FloatingStatusBar_Minion.UI_FloatingStatusBar_Minion_C"));
-	if (!UIFloatingStatusBarClass)
+	// Loaded asynchronously in InitializeFloatingStatusBar() or preloaded by the GDMinionWaveSubsystem
+	UIFloatingStatusBarClass = TSoftClassPtr<UGDFloatingStatusBarWidget>(FSoftObjectPath(TEXT("/Game/GASDocumentation/UI/UI_FloatingStatusBar_Minion.UI_FloatingStatusBar_Minion_C")));
+
+	AbilitySystemInitialized = false;
+	DeferAbilitySystemInitialization = false;
+}
+
+void AGDMinionCharacter::InitializeAbilitySystem()
+{
+	// Only initialize once
+	if (AbilitySystemInitialized || !AbilitySystemComponent)
 	{
-		UE_LOG(LogTemp, Error, TEXT("%s() Failed to find UIFloatingStatusBarClass. If it was moved, please update the reference location in C++."), TEXT(__FUNCTION__));
+		return;
 	}
+
+	AbilitySystemInitialized = true;
+
+	AbilitySystemComponent->InitAbilityActorInfo(this, this);
+	InitializeAttributes();
+	AddStartupEffects();
+	AddCharacterAbilities();
+
+	InitializeFloatingStatusBar();
+
+	// Attribute change callbacks
+	HealthChangedDelegateHandle = AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(AttributeSetBase->GetHealthAttribute()).AddUObject(this, &AGDMinionCharacter::HealthChanged);
+
+	// Tag change callbacks
+	AbilitySystemComponent->RegisterGameplayTagEvent(FGameplayTag::RequestGameplayTag(FName("State.Debuff.Stun")), EGameplayTagEventType::NewOrRemoved).AddUObject(this, &AGDMinionCharacter::StunTagChanged);
+}
+
+bool AGDMinionCharacter::IsAbilitySystemInitialized() const
+{
+	return AbilitySystemInitialized;
+}
+
+TSoftClassPtr<UGDFloatingStatusBarWidget> AGDMinionCharacter::GetFloatingStatusBarClass() const
+{
+	return UIFloatingStatusBarClass;
 }
 
 void AGDMinionCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
-	if (AbilitySystemComponent)
+	// Minions spawned in waves are initialized by the GDMinionWaveSubsystem under its frame budget
+	if (!DeferAbilitySystemInitialization)
 	{
-		AbilitySystemComponent->InitAbilityActorInfo(this, this);
-		InitializeAttributes();
-		AddStartupEffects();
-		AddCharacterAbilities();
-
-		// Setup FloatingStatusBar UI for Locally Owned Players only, not AI or the server's copy of the PlayerControllers
-		APlayerController* PC = UGameplayStatics::GetPlayerController(GetWorld(), 0);
-		if (PC && PC->IsLocalPlayerController())
-		{
-			if (UIFloatingStatusBarClass)
-			{
-				UIFloatingStatusBar = CreateWidget<UGDFloatingStatusBarWidget>(PC, UIFloatingStatusBarClass);
-				if (UIFloatingStatusBar && UIFloatingStatusBarComponent)
-				{
-					UIFloatingStatusBarComponent->SetWidget(UIFloatingStatusBar);
+		InitializeAbilitySystem();
+	}
+}
 
-					// Setup the floating status bar
-					UIFloatingStatusBar->SetHealthPercentage(GetHealth() / GetMaxHealth());
+void AGDMinionCharacter::InitializeFloatingStatusBar()
+{
+	// Only create once
+	if (UIFloatingStatusBar)
+	{
+		return;
+	}
 
-					UIFloatingStatusBar->SetCharacterName(CharacterName);
-				}
+	// Setup FloatingStatusBar UI for Locally Owned Players only, not AI or the server's copy of the PlayerControllers
+	APlayerController* PC = UGameplayStatics::GetPlayerController(GetWorld(), 0);
+	if (PC && PC->IsLocalPlayerController())
+	{
+		UClass* StatusBarClass = UIFloatingStatusBarClass.Get();
+		if (!StatusBarClass)
+		{
+			if (!UIFloatingStatusBarClass.IsNull())
+			{
+				// Not preloaded (i.e. minion was placed in the level). Create the widget when the class finishes loading instead of hitching here.
+				UAssetManager::GetStreamableManager().RequestAsyncLoad(UIFloatingStatusBarClass.ToSoftObjectPath(),
+					FStreamableDelegate::CreateUObject(this, &AGDMinionCharacter::InitializeFloatingStatusBar));
 			}
+
+			return;
 		}
 
-		// Attribute change callbacks
-		HealthChangedDelegateHandle = AbilitySystemComponent->GetGameplayAttributeValueChangeDelegate(AttributeSetBase->GetHealthAttribute()).AddUObject(this, &AGDMinionCharacter::HealthChanged);
+		UIFloatingStatusBar = CreateWidget<UGDFloatingStatusBarWidget>(PC, StatusBarClass);
+		if (UIFloatingStatusBar && UIFloatingStatusBarComponent)
+		{
+			UIFloatingStatusBarComponent->SetWidget(UIFloatingStatusBar);
 
-		// Tag change callbacks
-		AbilitySystemComponent->RegisterGameplayTagEvent(FGameplayTag::RequestGameplayTag(FName("State.Debuff.Stun")), EGameplayTagEventType::NewOrRemoved).AddUObject(this, &AGDMinionCharacter::StunTagChanged);
+			// Setup the floating status bar
+			UIFloatingStatusBar->SetHealthPercentage(GetHealth() / GetMaxHealth());
+
+			UIFloatingStatusBar->SetCharacterName(CharacterName);
+		}
 	}
 }
 
@@ -95,20 +146,25 @@ void AGDMinionCharacter::HealthChanged(const FOnAttributeChangeData & Data)
 	// If the minion died, handle death
 	if (!IsAlive() && !AbilitySystemComponent->HasMatchingGameplayTag(DeadTag))
 	{
-		Die();
+		// Gate right away, the rest of Die() waits for the end of the frame
+		UGDCrowdControlSubsystem::ApplyDeath(AbilitySystemComponent);
+
+		UGDCrowdControlSubsystem* CrowdControl = UGDCrowdControlSubsystem::Get(this);
+		if (CrowdControl)
+		{
+			CrowdControl->QueueDeath(this);
+		}
+		else
+		{
+			Die();
+		}
 	}
 }
 
 void AGDMinionCharacter::StunTagChanged(const FGameplayTag CallbackTag, int32 NewCount)
 {
-	if (NewCount > 0 && AbilitySystemComponent)
+	if (NewCount > 0)
 	{
-		FGameplayTagContainer AbilityTagsToCancel;
-		AbilityTagsToCancel.AddTag(FGameplayTag::RequestGameplayTag(FName("Ability")));
-
-		FGameplayTagContainer AbilityTagsToIgnore;
-		AbilityTagsToIgnore.AddTag(FGameplayTag::RequestGameplayTag(FName("Ability.NotCanceledByStun")));
-
-		AbilitySystemComponent->CancelAbilities(&AbilityTagsToCancel, &AbilityTagsToIgnore);
+		UGDCrowdControlSubsystem::ApplyStun(AbilitySystemComponent);
 	}
 }
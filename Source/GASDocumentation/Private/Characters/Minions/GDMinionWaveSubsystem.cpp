@@ -0,0 +1,222 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDMinionWaveSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GASDocumentation.h"
+#include "GDFloatingStatusBarWidget.h"
+#include "GDMinionCharacter.h"
+
+DECLARE_CYCLE_STAT(TEXT("MinionWave Tick"), STAT_GDMinionWaveTick, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("MinionWave Spawned"), STAT_GDMinionWaveSpawned, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("MinionWave Initialized"), STAT_GDMinionWaveInitialized, STATGROUP_GASDocumentation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("MinionWave Pending"), STAT_GDMinionWavePending, STATGROUP_GASDocumentation);
+
+UGDMinionWaveSubsystem::UGDMinionWaveSubsystem()
+{
+	FrameBudgetMilliseconds = 2.0f;
+	MinOperationsPerFrame = 1;
+	NumPendingSpawns = 0;
+	NumPendingInitializations = 0;
+}
+
+void UGDMinionWaveSubsystem::PreloadMinionClass(TSoftClassPtr<AGDMinionCharacter> MinionClass)
+{
+	if (MinionClass.IsNull() || PreloadHandles.Contains(MinionClass.ToSoftObjectPath()))
+	{
+		return;
+	}
+
+	TSharedPtr<FStreamableHandle> Handle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MinionClass.ToSoftObjectPath(),
+		FStreamableDelegate::CreateUObject(this, &UGDMinionWaveSubsystem::OnMinionClassLoaded, MinionClass));
+
+	PreloadHandles.Add(MinionClass.ToSoftObjectPath(), Handle);
+}
+
+int32 UGDMinionWaveSubsystem::SpawnWave(TSoftClassPtr<AGDMinionCharacter> MinionClass, const TArray<FTransform>& SpawnTransforms)
+{
+	UWorld* World = GetTickableGameObjectWorld();
+	if (!World || World->GetNetMode() == NM_Client || MinionClass.IsNull())
+	{
+		return 0;
+	}
+
+	PreloadMinionClass(MinionClass);
+
+	for (const FTransform& SpawnTransform : SpawnTransforms)
+	{
+		PendingSpawns.Enqueue(FGDPendingMinionSpawn{ MinionClass, SpawnTransform });
+	}
+
+	NumPendingSpawns += SpawnTransforms.Num();
+
+	return SpawnTransforms.Num();
+}
+
+int32 UGDMinionWaveSubsystem::GetNumPendingMinions() const
+{
+	return NumPendingSpawns + NumPendingInitializations;
+}
+
+void UGDMinionWaveSubsystem::Deinitialize()
+{
+	PendingSpawns.Empty();
+	PendingInitializations.Empty();
+	NumPendingSpawns = 0;
+	NumPendingInitializations = 0;
+
+	for (TPair<FSoftObjectPath, TSharedPtr<FStreamableHandle>>& PreloadHandle : PreloadHandles)
+	{
+		if (PreloadHandle.Value.IsValid())
+		{
+			PreloadHandle.Value->ReleaseHandle();
+		}
+	}
+
+	PreloadHandles.Empty();
+
+	Super::Deinitialize();
+}
+
+void UGDMinionWaveSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GDMinionWaveTick);
+
+	const double EndTime = FPlatformTime::Seconds() + FrameBudgetMilliseconds / 1000.0;
+	int32 NumOperations = 0;
+
+	// Finish minions that were already spawned first so that minions become active in the order that they were queued
+	while (NumPendingInitializations > 0 && (NumOperations < MinOperationsPerFrame || FPlatformTime::Seconds() < EndTime))
+	{
+		InitializeNextMinion();
+		NumOperations++;
+	}
+
+	while (NumPendingSpawns > 0 && (NumOperations < MinOperationsPerFrame || FPlatformTime::Seconds() < EndTime))
+	{
+		if (!SpawnNextMinion())
+		{
+			// Waiting on the async load of the next minion's class
+			break;
+		}
+
+		NumOperations++;
+	}
+
+	SET_DWORD_STAT(STAT_GDMinionWavePending, GetNumPendingMinions());
+}
+
+bool UGDMinionWaveSubsystem::IsTickable() const
+{
+	return !HasAnyFlags(RF_ClassDefaultObject) && GetNumPendingMinions() > 0;
+}
+
+TStatId UGDMinionWaveSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGDMinionWaveSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UGDMinionWaveSubsystem::GetTickableGameObjectWorld() const
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	return GameInstance ? GameInstance->GetWorld() : nullptr;
+}
+
+void UGDMinionWaveSubsystem::OnMinionClassLoaded(TSoftClassPtr<AGDMinionCharacter> MinionClass)
+{
+	UClass* LoadedClass = MinionClass.Get();
+	if (!LoadedClass)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s() Failed to load minion class %s."), TEXT(__FUNCTION__), *MinionClass.ToString());
+		return;
+	}
+
+	// Dedicated Servers never create the floating status bars
+	if (IsRunningDedicatedServer())
+	{
+		return;
+	}
+
+	TSoftClassPtr<UGDFloatingStatusBarWidget> StatusBarClass = LoadedClass->GetDefaultObject<AGDMinionCharacter>()->GetFloatingStatusBarClass();
+	if (!StatusBarClass.IsNull() && !PreloadHandles.Contains(StatusBarClass.ToSoftObjectPath()))
+	{
+		PreloadHandles.Add(StatusBarClass.ToSoftObjectPath(), UAssetManager::GetStreamableManager().RequestAsyncLoad(StatusBarClass.ToSoftObjectPath()));
+	}
+}
+
+bool UGDMinionWaveSubsystem::SpawnNextMinion()
+{
+	FGDPendingMinionSpawn* PendingSpawn = PendingSpawns.Peek();
+	if (!PendingSpawn)
+	{
+		NumPendingSpawns = 0;
+		return false;
+	}
+
+	UClass* MinionClass = PendingSpawn->MinionClass.Get();
+	if (!MinionClass)
+	{
+		const FSoftObjectPath& MinionClassPath = PendingSpawn->MinionClass.ToSoftObjectPath();
+		const TSharedPtr<FStreamableHandle>* Handle = PreloadHandles.Find(MinionClassPath);
+		if (Handle && Handle->IsValid() && (*Handle)->IsLoadingInProgress())
+		{
+			return false;
+		}
+
+		// Failed to load. Drop the spawn so that the rest of the queue isn't stuck behind it.
+		PendingSpawns.Pop();
+		NumPendingSpawns--;
+		return true;
+	}
+
+	const FTransform SpawnTransform = PendingSpawn->Transform;
+	PendingSpawns.Pop();
+	NumPendingSpawns--;
+
+	UWorld* World = GetTickableGameObjectWorld();
+	if (!World)
+	{
+		return true;
+	}
+
+	AGDMinionCharacter* Minion = World->SpawnActorDeferred<AGDMinionCharacter>(MinionClass, SpawnTransform, nullptr, nullptr,
+		ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+	if (Minion)
+	{
+		Minion->DeferAbilitySystemInitialization = true;
+		Minion->FinishSpawning(SpawnTransform);
+
+		if (!Minion->GetController())
+		{
+			Minion->SpawnDefaultController();
+		}
+
+		PendingInitializations.Enqueue(Minion);
+		NumPendingInitializations++;
+
+		INC_DWORD_STAT(STAT_GDMinionWaveSpawned);
+	}
+
+	return true;
+}
+
+void UGDMinionWaveSubsystem::InitializeNextMinion()
+{
+	TWeakObjectPtr<AGDMinionCharacter> Minion;
+	if (!PendingInitializations.Dequeue(Minion))
+	{
+		NumPendingInitializations = 0;
+		return;
+	}
+
+	NumPendingInitializations--;
+
+	if (Minion.IsValid())
+	{
+		Minion->InitializeAbilitySystem();
+
+		INC_DWORD_STAT(STAT_GDMinionWaveInitialized);
+	}
+}
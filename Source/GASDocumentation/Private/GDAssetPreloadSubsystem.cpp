@@ -0,0 +1,200 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDAssetPreloadSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GASDocumentation.h"
+#include "HAL/IConsoleManager.h"
+#include "UObject/UObjectGlobals.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Preload Gameplay Sync Loads"), STAT_GDPreloadGameplaySyncLoads, STATGROUP_GASDocumentation);
+
+static FAutoConsoleCommandWithWorld CVarGDPreloadReport(
+	TEXT("GD.Preload.Report"),
+	TEXT("Logs the asset preload timings and any synchronous loads that happened during gameplay."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		UGDAssetPreloadSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UGDAssetPreloadSubsystem>() : nullptr;
+		if (Subsystem)
+		{
+			Subsystem->LogReport();
+		}
+	}));
+
+UClass* UGDAssetPreloadSubsystem::LoadClassSynchronously(const UObject* WorldContextObject, const FSoftObjectPath& ClassPath)
+{
+	UGDAssetPreloadSubsystem* Subsystem = nullptr;
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	if (World && World->GetGameInstance())
+	{
+		Subsystem = World->GetGameInstance()->GetSubsystem<UGDAssetPreloadSubsystem>();
+	}
+
+	if (Subsystem && Subsystem->bGameplayStarted)
+	{
+		Subsystem->NumGameplaySyncLoads++;
+		Subsystem->GameplaySyncLoads.AddUnique(ClassPath);
+		INC_DWORD_STAT(STAT_GDPreloadGameplaySyncLoads);
+
+		UE_LOG(LogTemp, Warning, TEXT("%s() Synchronously loading %s during gameplay. Add it to the GDAssetPreloadSubsystem preload lists in DefaultGame.ini."),
+			TEXT(__FUNCTION__), *ClassPath.ToString());
+	}
+
+	return Cast<UClass>(ClassPath.TryLoad());
+}
+
+bool UGDAssetPreloadSubsystem::IsPreloadComplete() const
+{
+	return PreloadHandle.IsValid() && PreloadHandle->HasLoadCompleted();
+}
+
+int32 UGDAssetPreloadSubsystem::GetNumGameplaySyncLoads() const
+{
+	return NumGameplaySyncLoads;
+}
+
+void UGDAssetPreloadSubsystem::LogReport() const
+{
+	UE_LOG(LogTemp, Log, TEXT("Asset preload report"));
+
+	if (IsPreloadComplete())
+	{
+		UE_LOG(LogTemp, Log, TEXT("  Preload %d loaded %d classes asynchronously in %.2f ms, finishing %.2f ms after the map loaded"), NumPreloadRuns, NumPreloaded,
+			PreloadSeconds * 1000.0, PreloadSecondsAfterMapLoad * 1000.0);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Log, TEXT("  Preload %d of %d classes still in progress"), NumPreloadRuns, NumPreloaded);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("  Map %s loaded in %.2f ms"), *LastMapName, MapLoadSeconds * 1000.0);
+	UE_LOG(LogTemp, Log, TEXT("  %d synchronous loads during gameplay"), NumGameplaySyncLoads);
+
+	for (const FSoftObjectPath& ClassPath : GameplaySyncLoads)
+	{
+		UE_LOG(LogTemp, Log, TEXT("    %s"), *ClassPath.ToString());
+	}
+}
+
+void UGDAssetPreloadSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PreloadStartTime = 0.0;
+	PreloadSeconds = 0.0;
+	NumPreloaded = 0;
+	NumPreloadRuns = 0;
+	MapLoadStartTime = 0.0;
+	MapLoadEndTime = 0.0;
+	MapLoadSeconds = 0.0;
+	PreloadSecondsAfterMapLoad = 0.0;
+	bGameplayStarted = false;
+	NumGameplaySyncLoads = 0;
+
+	PreLoadMapDelegateHandle = FCoreUObjectDelegates::PreLoadMap.AddUObject(this, &UGDAssetPreloadSubsystem::OnPreLoadMap);
+	PostLoadMapDelegateHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UGDAssetPreloadSubsystem::OnPostLoadMap);
+
+	// The GameInstance initializes right before the first map loads
+	StartPreload();
+}
+
+void UGDAssetPreloadSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PreLoadMap.Remove(PreLoadMapDelegateHandle);
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapDelegateHandle);
+
+	if (PreloadHandle.IsValid())
+	{
+		PreloadHandle->ReleaseHandle();
+		PreloadHandle.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
+void UGDAssetPreloadSubsystem::StartPreload()
+{
+	// A preload that is still running keeps going through the next map load
+	if (PreloadHandle.IsValid() && !PreloadHandle->HasLoadCompleted())
+	{
+		return;
+	}
+
+	TArray<FSoftObjectPath> AssetsToLoad;
+	for (const FSoftClassPath& ClassPath : PreloadClasses)
+	{
+		AssetsToLoad.AddUnique(ClassPath);
+	}
+
+	if (!IsRunningDedicatedServer())
+	{
+		for (const FSoftClassPath& ClassPath : ClientPreloadClasses)
+		{
+			AssetsToLoad.AddUnique(ClassPath);
+		}
+	}
+
+	if (AssetsToLoad.Num() == 0)
+	{
+		return;
+	}
+
+	NumPreloaded = AssetsToLoad.Num();
+	NumPreloadRuns++;
+	PreloadStartTime = FPlatformTime::Seconds();
+	PreloadSeconds = 0.0;
+	PreloadSecondsAfterMapLoad = 0.0;
+
+	// Request the new handle before releasing the previous one so that classes that are still loaded aren't garbage collected in between
+	TSharedPtr<FStreamableHandle> PreviousPreloadHandle = PreloadHandle;
+	PreloadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(AssetsToLoad, FStreamableDelegate::CreateUObject(this, &UGDAssetPreloadSubsystem::OnPreloadComplete),
+		FStreamableManager::AsyncLoadHighPriority);
+
+	if (PreviousPreloadHandle.IsValid())
+	{
+		PreviousPreloadHandle->ReleaseHandle();
+	}
+}
+
+void UGDAssetPreloadSubsystem::OnPreloadComplete()
+{
+	const double PreloadEndTime = FPlatformTime::Seconds();
+	PreloadSeconds = PreloadEndTime - PreloadStartTime;
+
+	// The map this preload started for already finished loading, so gameplay ran while the classes were still loading
+	if (MapLoadEndTime > MapLoadStartTime && MapLoadEndTime > PreloadStartTime)
+	{
+		PreloadSecondsAfterMapLoad = PreloadEndTime - MapLoadEndTime;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("%s() Preloaded %d classes in %.2f ms"), TEXT(__FUNCTION__), NumPreloaded, PreloadSeconds * 1000.0);
+}
+
+void UGDAssetPreloadSubsystem::OnPreLoadMap(const FString& MapName)
+{
+	MapLoadStartTime = FPlatformTime::Seconds();
+	LastMapName = MapName;
+
+	// Loads during travel aren't gameplay hitches
+	bGameplayStarted = false;
+
+	StartPreload();
+}
+
+void UGDAssetPreloadSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	MapLoadEndTime = FPlatformTime::Seconds();
+	if (MapLoadStartTime > 0.0)
+	{
+		MapLoadSeconds = MapLoadEndTime - MapLoadStartTime;
+	}
+
+	// Anything loaded synchronously from here on is a hitch during gameplay
+	bGameplayStarted = true;
+
+	LogReport();
+}
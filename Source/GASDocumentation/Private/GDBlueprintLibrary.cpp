@@ -2,3 +2,52 @@
 
 
 #include "GDBlueprintLibrary.h"
+#include "AbilitySystemComponent.h"
+#include "AbilitySystemGlobals.h"
+#include "Engine/GameInstance.h"
+#include "GDDamageExecCalculation.h"
+#include "GDMassMinionCharacter.h"
+
+void UGDBlueprintLibrary::ApplyGameplayEffectSpecToActor(const FGameplayEffectSpecHandle& SpecHandle, AActor* TargetActor)
+{
+	if (!SpecHandle.IsValid() || !TargetActor || TargetActor->Role != ROLE_Authority)
+	{
+		return;
+	}
+
+	UAbilitySystemComponent* TargetASC = UAbilitySystemGlobals::GetAbilitySystemComponentFromActor(TargetActor);
+	if (TargetASC)
+	{
+		TargetASC->ApplyGameplayEffectSpecToSelf(*SpecHandle.Data.Get());
+		return;
+	}
+
+	AGDMassMinionCharacter* MassMinion = Cast<AGDMassMinionCharacter>(TargetActor);
+	UGameInstance* GameInstance = TargetActor->GetGameInstance();
+	if (MassMinion && GameInstance)
+	{
+		UGDMassMinionSubsystem* MassMinionSubsystem = GameInstance->GetSubsystem<UGDMassMinionSubsystem>();
+		if (MassMinionSubsystem)
+		{
+			MassMinionSubsystem->ApplyDamageEffectSpec(MassMinion->GetMassMinionIndex(), *SpecHandle.Data.Get());
+		}
+	}
+}
+
+void UGDBlueprintLibrary::ApplyDamageEffectSpecToActors(const FGameplayEffectSpecHandle& SpecHandle, const TArray<AActor*>& TargetActors)
+{
+	if (!SpecHandle.IsValid())
+	{
+		return;
+	}
+
+	TArray<FGDDamageBatchEntry> Entries;
+	Entries.Reserve(TargetActors.Num());
+
+	for (AActor* TargetActor : TargetActors)
+	{
+		Entries.Add(FGDDamageBatchEntry{ SpecHandle, TargetActor });
+	}
+
+	UGDDamageExecCalculation::ApplyDamageBatch(Entries);
+}
@@ -0,0 +1,316 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDCombatEventSubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "GASDocumentation.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("CombatLog Recorded"), STAT_GDCombatLogRecorded, STATGROUP_GASDocumentation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("CombatLog Dropped"), STAT_GDCombatLogDropped, STATGROUP_GASDocumentation);
+
+static UGDCombatEventSubsystem* GetCombatEventSubsystem(UWorld* World)
+{
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UGDCombatEventSubsystem>() : nullptr;
+}
+
+static FAutoConsoleCommandWithWorld CVarGDCombatLogStart(
+	TEXT("GD.CombatLog.Start"),
+	TEXT("Starts recording combat events to Saved/CombatLogs."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UGDCombatEventSubsystem* Subsystem = GetCombatEventSubsystem(World);
+		if (Subsystem)
+		{
+			Subsystem->StartRecording();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld CVarGDCombatLogStop(
+	TEXT("GD.CombatLog.Stop"),
+	TEXT("Stops recording combat events and closes the combat log."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UGDCombatEventSubsystem* Subsystem = GetCombatEventSubsystem(World);
+		if (Subsystem)
+		{
+			Subsystem->StopRecording();
+		}
+	}));
+
+// Header at the start of every combat log, followed by FGDCombatEventRecords until the end of the file
+struct FGDCombatLogHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	uint32 RecordSize;
+};
+
+static const uint32 GDCombatLogMagic = 0x4C434447; // "GDCL"
+static const uint32 GDCombatLogVersion = 1;
+
+/**
+ * Drains the ring buffer to the combat log on its own thread. Wakes up a few times a second, so the game thread never waits on it.
+ */
+class FGDCombatEventWriter : public FRunnable
+{
+public:
+	FGDCombatEventWriter(FGDCombatEventRingBuffer& InRingBuffer, const FString& InFilename)
+		: RingBuffer(InRingBuffer), Filename(InFilename), bStopRequested(false)
+	{
+		WakeEvent = FPlatformProcess::GetSynchEventFromPool();
+	}
+
+	virtual ~FGDCombatEventWriter()
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	}
+
+	virtual uint32 Run() override
+	{
+		IFileHandle* FileHandle = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Filename);
+		if (!FileHandle)
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s() Couldn't open combat log %s"), TEXT(__FUNCTION__), *Filename);
+			return 1;
+		}
+
+		const FGDCombatLogHeader Header = { GDCombatLogMagic, GDCombatLogVersion, sizeof(FGDCombatEventRecord) };
+		FileHandle->Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+
+		while (!bStopRequested)
+		{
+			if (!Drain(FileHandle))
+			{
+				WakeEvent->Wait(100);
+			}
+		}
+
+		// Everything pushed before the stop request
+		while (Drain(FileHandle))
+		{
+		}
+
+		FileHandle->Flush();
+		delete FileHandle;
+
+		return 0;
+	}
+
+	virtual void Stop() override
+	{
+		bStopRequested = true;
+		WakeEvent->Trigger();
+	}
+
+private:
+	FGDCombatEventRingBuffer& RingBuffer;
+	FString Filename;
+	FThreadSafeBool bStopRequested;
+	FEvent* WakeEvent;
+
+	static const int32 BatchSize = 1024;
+	FGDCombatEventRecord Batch[BatchSize];
+
+	// Returns true if anything was written
+	bool Drain(IFileHandle* FileHandle)
+	{
+		const int32 NumRecords = RingBuffer.Pop(Batch, BatchSize);
+		if (NumRecords > 0)
+		{
+			FileHandle->Write(reinterpret_cast<const uint8*>(Batch), NumRecords * sizeof(FGDCombatEventRecord));
+		}
+
+		return NumRecords > 0;
+	}
+};
+
+void FGDCombatEventRingBuffer::Init(uint32 Capacity)
+{
+	Capacity = FMath::RoundUpToPowerOfTwo(FMath::Max<uint32>(Capacity, 2));
+	Records.SetNumZeroed(Capacity);
+	Mask = Capacity - 1;
+	Head.Store(0);
+	Tail.Store(0);
+}
+
+bool FGDCombatEventRingBuffer::Push(const FGDCombatEventRecord& Record)
+{
+	const uint32 CurrentHead = Head.Load(EMemoryOrder::Relaxed);
+	if (CurrentHead - Tail.Load() > Mask)
+	{
+		return false;
+	}
+
+	Records[CurrentHead & Mask] = Record;
+
+	// Publishes the record to the consumer
+	Head.Store(CurrentHead + 1);
+	return true;
+}
+
+int32 FGDCombatEventRingBuffer::Pop(FGDCombatEventRecord* OutRecords, int32 MaxRecords)
+{
+	const uint32 CurrentTail = Tail.Load(EMemoryOrder::Relaxed);
+	const int32 NumRecords = FMath::Min<int32>(Head.Load() - CurrentTail, MaxRecords);
+
+	for (int32 Index = 0; Index < NumRecords; Index++)
+	{
+		OutRecords[Index] = Records[(CurrentTail + Index) & Mask];
+	}
+
+	// Hands the slots back to the producer
+	Tail.Store(CurrentTail + NumRecords);
+	return NumRecords;
+}
+
+void UGDCombatEventSubsystem::Record(EGDCombatEventType Type, const AActor* Source, const AActor* Target, float Value, float Value2)
+{
+	const AActor* ContextActor = Target ? Target : Source;
+	UGameInstance* GameInstance = ContextActor ? ContextActor->GetGameInstance() : nullptr;
+	UGDCombatEventSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UGDCombatEventSubsystem>() : nullptr;
+	if (Subsystem && Subsystem->IsRecording())
+	{
+		check(IsInGameThread());
+		Subsystem->PushRecord(Type, Source, Target, Value, Value2);
+	}
+}
+
+void UGDCombatEventSubsystem::StartRecording()
+{
+	if (IsRecording())
+	{
+		return;
+	}
+
+	const FString Directory = FPaths::ProjectSavedDir() / TEXT("CombatLogs");
+	FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*Directory);
+	LogFilename = Directory / FString::Printf(TEXT("Combat_%s.gdcl"), *FDateTime::Now().ToString());
+
+	RingBuffer.Init(RingBufferCapacity);
+	RecordedActors.Reset();
+	ActorIds.Reset();
+	NextActorId = 1;
+	NumRecorded = 0;
+	NumDropped = 0;
+
+	Writer = MakeUnique<FGDCombatEventWriter>(RingBuffer, LogFilename);
+	WriterThread = FRunnableThread::Create(Writer.Get(), TEXT("GDCombatEventWriter"), 0, TPri_BelowNormal);
+
+	UE_LOG(LogTemp, Log, TEXT("%s() Recording combat events to %s"), TEXT(__FUNCTION__), *LogFilename);
+}
+
+void UGDCombatEventSubsystem::StopRecording()
+{
+	if (!IsRecording())
+	{
+		return;
+	}
+
+	Writer->Stop();
+	WriterThread->WaitForCompletion();
+	delete WriterThread;
+	WriterThread = nullptr;
+	Writer.Reset();
+
+	WriteActorTable();
+
+	UE_LOG(LogTemp, Log, TEXT("%s() Wrote %d combat events to %s, %d dropped"), TEXT(__FUNCTION__), NumRecorded, *LogFilename, NumDropped);
+}
+
+bool UGDCombatEventSubsystem::IsRecording() const
+{
+	return WriterThread != nullptr;
+}
+
+void UGDCombatEventSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	WriterThread = nullptr;
+	NextActorId = 1;
+
+	if (bRecordOnStart)
+	{
+		StartRecording();
+	}
+}
+
+void UGDCombatEventSubsystem::Deinitialize()
+{
+	StopRecording();
+
+	Super::Deinitialize();
+}
+
+uint32 UGDCombatEventSubsystem::GetActorId(const AActor* Actor)
+{
+	if (!Actor)
+	{
+		return 0;
+	}
+
+	const uint32* ExistingActorId = ActorIds.Find(Actor);
+	if (ExistingActorId)
+	{
+		return *ExistingActorId;
+	}
+
+	// 0 is no actor
+	const uint32 ActorId = NextActorId++;
+	ActorIds.Add(Actor, ActorId);
+	RecordedActors.Add(ActorId, FString::Printf(TEXT("%s,%s"), *Actor->GetName(), *Actor->GetClass()->GetName()));
+
+	return ActorId;
+}
+
+void UGDCombatEventSubsystem::PushRecord(EGDCombatEventType Type, const AActor* Source, const AActor* Target, float Value, float Value2)
+{
+	const AActor* ContextActor = Target ? Target : Source;
+	const FVector Location = ContextActor->GetActorLocation();
+	UWorld* World = ContextActor->GetWorld();
+
+	FGDCombatEventRecord Record;
+	Record.Time = World ? World->GetTimeSeconds() : 0.0f;
+	Record.SourceId = GetActorId(Source);
+	Record.TargetId = GetActorId(Target);
+	Record.Value = Value;
+	Record.Value2 = Value2;
+	Record.X = Location.X;
+	Record.Y = Location.Y;
+	Record.Z = Location.Z;
+	Record.Type = static_cast<uint8>(Type);
+	Record.Padding[0] = Record.Padding[1] = Record.Padding[2] = 0;
+
+	if (RingBuffer.Push(Record))
+	{
+		NumRecorded++;
+		INC_DWORD_STAT(STAT_GDCombatLogRecorded);
+	}
+	else
+	{
+		NumDropped++;
+		INC_DWORD_STAT(STAT_GDCombatLogDropped);
+	}
+}
+
+void UGDCombatEventSubsystem::WriteActorTable() const
+{
+	FString ActorTable = TEXT("Id,Name,Class\n");
+	for (const TPair<uint32, FString>& Actor : RecordedActors)
+	{
+		ActorTable += FString::Printf(TEXT("%u,%s\n"), Actor.Key, *Actor.Value);
+	}
+
+	FFileHelper::SaveStringToFile(ActorTable, *FPaths::ChangeExtension(LogFilename, TEXT("actors.csv")));
+}
@@ -0,0 +1,343 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDFXPoolSubsystem.h"
+#include "Engine/AssetManager.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "GASDocumentation.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FXPool Pooled Components"), STAT_GDFXPoolComponents, STATGROUP_GASDocumentation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FXPool Active Components"), STAT_GDFXPoolActiveComponents, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("FXPool Reused"), STAT_GDFXPoolReused, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("FXPool Allocated"), STAT_GDFXPoolAllocated, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("FXPool Dropped"), STAT_GDFXPoolDropped, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("FXPool Unpooled"), STAT_GDFXPoolUnpooled, STATGROUP_GASDocumentation);
+
+static FAutoConsoleCommandWithWorld CVarGDFXPoolStats(
+	TEXT("GD.FXPool.Stats"),
+	TEXT("Logs the FX pool sizes and how many effects were reused, allocated and dropped by the budget."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UGDFXPoolSubsystem* FXPool = UGDFXPoolSubsystem::Get(World);
+		if (FXPool)
+		{
+			FXPool->LogStats();
+		}
+	}));
+
+UGDFXPoolSubsystem::UGDFXPoolSubsystem()
+{
+	MaxLowPriorityEffectsPerFrame = 16;
+	LowPriorityCullDistance = 8000.0f;
+	MaxPooledEmittersPerTemplate = 32;
+	PreallocationsPerFrame = 4;
+}
+
+UGDFXPoolSubsystem* UGDFXPoolSubsystem::Get(const UObject* WorldContextObject)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UGDFXPoolSubsystem>() : nullptr;
+}
+
+UParticleSystemComponent* UGDFXPoolSubsystem::SpawnEmitter(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation, EGDFXPriority Priority)
+{
+	if (!Template || !UpdatePoolWorld())
+	{
+		return nullptr;
+	}
+
+	UWorld* World = PoolWorld.Get();
+
+	if (Priority == EGDFXPriority::Low && ShouldDropLowPriorityEffect(World, Location))
+	{
+		NumDropped++;
+		INC_DWORD_STAT(STAT_GDFXPoolDropped);
+		return nullptr;
+	}
+
+	FGDEmitterPool& Pool = EmitterPools.FindOrAdd(Template);
+
+	UParticleSystemComponent* ParticleSystemComponent = nullptr;
+	while (!ParticleSystemComponent && Pool.FreeComponents.Num() > 0)
+	{
+		ParticleSystemComponent = Pool.FreeComponents.Pop(false);
+		if (!IsValid(ParticleSystemComponent))
+		{
+			ParticleSystemComponent = nullptr;
+			Pool.NumComponents--;
+			DEC_DWORD_STAT(STAT_GDFXPoolComponents);
+		}
+	}
+
+	if (ParticleSystemComponent)
+	{
+		NumReused++;
+		INC_DWORD_STAT(STAT_GDFXPoolReused);
+	}
+	else if (Pool.NumComponents < MaxPooledEmittersPerTemplate)
+	{
+		ParticleSystemComponent = CreatePooledComponent(World, Template, Pool);
+	}
+	else if (Priority == EGDFXPriority::High)
+	{
+		NumUnpooled++;
+		INC_DWORD_STAT(STAT_GDFXPoolUnpooled);
+		return UGameplayStatics::SpawnEmitterAtLocation(World, Template, Location, Rotation);
+	}
+	else
+	{
+		NumDropped++;
+		INC_DWORD_STAT(STAT_GDFXPoolDropped);
+		return nullptr;
+	}
+
+	NumSpawned++;
+	INC_DWORD_STAT(STAT_GDFXPoolActiveComponents);
+
+	ParticleSystemComponent->SetWorldLocationAndRotation(Location, Rotation);
+	ParticleSystemComponent->ActivateSystem(true);
+	return ParticleSystemComponent;
+}
+
+UParticleSystemComponent* UGDFXPoolSubsystem::SpawnPooledEmitterAtLocation(const UObject* WorldContextObject, UParticleSystem* Template, FVector Location, FRotator Rotation,
+	EGDFXPriority Priority)
+{
+	UGDFXPoolSubsystem* FXPool = Get(WorldContextObject);
+	if (FXPool)
+	{
+		return FXPool->SpawnEmitter(Template, Location, Rotation, Priority);
+	}
+
+	return UGameplayStatics::SpawnEmitterAtLocation(WorldContextObject, Template, Location, Rotation);
+}
+
+void UGDFXPoolSubsystem::LogStats() const
+{
+	UE_LOG(LogTemp, Log, TEXT("FX pool stats"));
+	UE_LOG(LogTemp, Log, TEXT("  %d spawned, %d reused, %d allocated, %d unpooled, %d dropped"), NumSpawned, NumReused, NumAllocated, NumUnpooled, NumDropped);
+
+	for (const TPair<UParticleSystem*, FGDEmitterPool>& Pair : EmitterPools)
+	{
+		UE_LOG(LogTemp, Log, TEXT("    %-48s %4d components, %4d free"), *GetNameSafe(Pair.Key), Pair.Value.NumComponents, Pair.Value.FreeComponents.Num());
+	}
+}
+
+bool UGDFXPoolSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	// Nothing to see on Dedicated Servers
+	return !IsRunningDedicatedServer();
+}
+
+void UGDFXPoolSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	bPreallocationComplete = true;
+	BudgetFrame = 0;
+	NumLowPriorityEffectsThisFrame = 0;
+	NumSpawned = 0;
+	NumReused = 0;
+	NumAllocated = 0;
+	NumDropped = 0;
+	NumUnpooled = 0;
+
+	WorldCleanupDelegateHandle = FWorldDelegates::OnWorldCleanup.AddUObject(this, &UGDFXPoolSubsystem::OnWorldCleanup);
+
+	TArray<FSoftObjectPath> AssetsToLoad;
+	for (const FGDPooledEmitterPreallocation& Preallocation : PreallocatedEmitters)
+	{
+		if (!Preallocation.Emitter.IsNull() && Preallocation.Count > 0)
+		{
+			AssetsToLoad.AddUnique(Preallocation.Emitter.ToSoftObjectPath());
+		}
+	}
+
+	if (AssetsToLoad.Num() > 0)
+	{
+		// The handle keeps them loaded for the lifetime of the GameInstance
+		PreallocationLoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(AssetsToLoad, FStreamableDelegate());
+		bPreallocationComplete = false;
+	}
+}
+
+void UGDFXPoolSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupDelegateHandle);
+
+	ResetPools();
+
+	if (PreallocationLoadHandle.IsValid())
+	{
+		PreallocationLoadHandle->ReleaseHandle();
+		PreallocationLoadHandle.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
+void UGDFXPoolSubsystem::Tick(float DeltaTime)
+{
+	if (UpdatePoolWorld())
+	{
+		UpdatePreallocation();
+	}
+}
+
+bool UGDFXPoolSubsystem::IsTickable() const
+{
+	return !HasAnyFlags(RF_ClassDefaultObject) && (!bPreallocationComplete || PoolWorld.Get() != GetTickableGameObjectWorld());
+}
+
+TStatId UGDFXPoolSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGDFXPoolSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UGDFXPoolSubsystem::GetTickableGameObjectWorld() const
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	return GameInstance ? GameInstance->GetWorld() : nullptr;
+}
+
+bool UGDFXPoolSubsystem::UpdatePoolWorld()
+{
+	UWorld* World = GetTickableGameObjectWorld();
+	if (World != PoolWorld.Get())
+	{
+		ResetPools();
+		PoolWorld = World;
+
+		// Preallocate again for the new world
+		bPreallocationComplete = !PreallocationLoadHandle.IsValid();
+	}
+
+	return World != nullptr;
+}
+
+void UGDFXPoolSubsystem::ResetPools()
+{
+	for (UParticleSystemComponent* ParticleSystemComponent : PooledComponents)
+	{
+		if (IsValid(ParticleSystemComponent))
+		{
+			ParticleSystemComponent->OnSystemFinished.RemoveAll(this);
+			ParticleSystemComponent->DestroyComponent();
+		}
+	}
+
+	SET_DWORD_STAT(STAT_GDFXPoolComponents, 0);
+	SET_DWORD_STAT(STAT_GDFXPoolActiveComponents, 0);
+
+	PooledComponents.Reset();
+	EmitterPools.Reset();
+	PoolWorld.Reset();
+}
+
+void UGDFXPoolSubsystem::UpdatePreallocation()
+{
+	UWorld* World = PoolWorld.Get();
+	if (bPreallocationComplete || !World || !World->HasBegunPlay() || !PreallocationLoadHandle.IsValid() || !PreallocationLoadHandle->HasLoadCompleted())
+	{
+		return;
+	}
+
+	int32 NumPreallocations = 0;
+
+	for (const FGDPooledEmitterPreallocation& Preallocation : PreallocatedEmitters)
+	{
+		UParticleSystem* Template = Preallocation.Emitter.Get();
+		if (!Template)
+		{
+			continue;
+		}
+
+		FGDEmitterPool& Pool = EmitterPools.FindOrAdd(Template);
+		const int32 Count = FMath::Min(Preallocation.Count, MaxPooledEmittersPerTemplate);
+		while (Pool.NumComponents < Count && NumPreallocations < PreallocationsPerFrame)
+		{
+			Pool.FreeComponents.Add(CreatePooledComponent(World, Template, Pool));
+			NumPreallocations++;
+		}
+	}
+
+	// Nothing was left to create
+	bPreallocationComplete = NumPreallocations == 0;
+}
+
+UParticleSystemComponent* UGDFXPoolSubsystem::CreatePooledComponent(UWorld* World, UParticleSystem* Template, FGDEmitterPool& Pool)
+{
+	UParticleSystemComponent* ParticleSystemComponent = NewObject<UParticleSystemComponent>(World);
+	ParticleSystemComponent->bAutoDestroy = false;
+	ParticleSystemComponent->bAutoActivate = false;
+	ParticleSystemComponent->SetTemplate(Template);
+	ParticleSystemComponent->OnSystemFinished.AddDynamic(this, &UGDFXPoolSubsystem::OnPooledEmitterFinished);
+	ParticleSystemComponent->RegisterComponentWithWorld(World);
+
+	PooledComponents.Add(ParticleSystemComponent);
+	Pool.NumComponents++;
+
+	NumAllocated++;
+	INC_DWORD_STAT(STAT_GDFXPoolAllocated);
+	INC_DWORD_STAT(STAT_GDFXPoolComponents);
+
+	return ParticleSystemComponent;
+}
+
+bool UGDFXPoolSubsystem::ShouldDropLowPriorityEffect(UWorld* World, const FVector& Location)
+{
+	if (BudgetFrame != GFrameCounter)
+	{
+		BudgetFrame = GFrameCounter;
+		NumLowPriorityEffectsThisFrame = 0;
+	}
+
+	if (NumLowPriorityEffectsThisFrame >= MaxLowPriorityEffectsPerFrame)
+	{
+		return true;
+	}
+
+	APlayerController* PlayerController = World->GetFirstPlayerController();
+	if (PlayerController && LowPriorityCullDistance > 0.0f)
+	{
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		if (FVector::DistSquared(ViewLocation, Location) > FMath::Square(LowPriorityCullDistance))
+		{
+			return true;
+		}
+	}
+
+	NumLowPriorityEffectsThisFrame++;
+	return false;
+}
+
+void UGDFXPoolSubsystem::OnPooledEmitterFinished(UParticleSystemComponent* ParticleSystemComponent)
+{
+	FGDEmitterPool* Pool = ParticleSystemComponent ? EmitterPools.Find(ParticleSystemComponent->Template) : nullptr;
+	if (!Pool || ParticleSystemComponent->GetWorld() != PoolWorld.Get())
+	{
+		return;
+	}
+
+	Pool->FreeComponents.Add(ParticleSystemComponent);
+	DEC_DWORD_STAT(STAT_GDFXPoolActiveComponents);
+}
+
+void UGDFXPoolSubsystem::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	// The pooled components belong to the world
+	if (World == PoolWorld.Get())
+	{
+		ResetPools();
+	}
+}
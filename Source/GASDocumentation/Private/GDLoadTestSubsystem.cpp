@@ -0,0 +1,353 @@
+// Copyright 2019 Dan Kestranek.
+
+
+#include "GDLoadTestSubsystem.h"
+#include "AbilitySystemComponent.h"
+#include "Engine/GameInstance.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerStart.h"
+#include "GDAbilitySystemComponent.h"
+#include "GDAssetPreloadSubsystem.h"
+#include "GDHeroAIController.h"
+#include "GDHeroCharacter.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "UObject/UObjectIterator.h"
+
+DECLARE_CYCLE_STAT(TEXT("LoadTest Tick"), STAT_GDLoadTestTick, STATGROUP_GASDocumentation);
+DECLARE_DWORD_COUNTER_STAT(TEXT("LoadTest Inputs Pressed"), STAT_GDLoadTestInputsPressed, STATGROUP_GASDocumentation);
+
+static FAutoConsoleCommandWithWorldAndArgs CVarGDLoadTestStart(
+	TEXT("GD.LoadTest.Start"),
+	TEXT("Starts a server load test. Args are the number of heroes (default 16) and the run length in seconds (default from DefaultGame.ini)."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		UGDLoadTestSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UGDLoadTestSubsystem>() : nullptr;
+		if (Subsystem)
+		{
+			const int32 NumHeroes = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 16;
+			const float DurationSeconds = Args.Num() > 1 ? FCString::Atof(*Args[1]) : Subsystem->DefaultDurationSeconds;
+			Subsystem->StartLoadTest(NumHeroes, DurationSeconds, false);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld CVarGDLoadTestStop(
+	TEXT("GD.LoadTest.Stop"),
+	TEXT("Ends the running load test early and logs its report."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		UGDLoadTestSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UGDLoadTestSubsystem>() : nullptr;
+		if (Subsystem)
+		{
+			Subsystem->StopLoadTest();
+		}
+	}));
+
+// Value at Percentile (0-1) of already sorted values
+static float GetPercentile(const TArray<float>& SortedValues, float Percentile)
+{
+	if (SortedValues.Num() == 0)
+	{
+		return 0.0f;
+	}
+
+	return SortedValues[FMath::Clamp(FMath::FloorToInt(Percentile * SortedValues.Num()), 0, SortedValues.Num() - 1)];
+}
+
+UGDLoadTestSubsystem::UGDLoadTestSubsystem()
+{
+	SpawnRadius = 1000.0f;
+	DefaultDurationSeconds = 120.0f;
+	bRunning = false;
+	bExitWhenDone = false;
+	StartTime = 0.0;
+	EndTime = 0.0;
+}
+
+UGDLoadTestSubsystem* UGDLoadTestSubsystem::Get(const AActor* Actor)
+{
+	UGameInstance* GameInstance = Actor ? Actor->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UGDLoadTestSubsystem>() : nullptr;
+}
+
+void UGDLoadTestSubsystem::StartFromCommandLine()
+{
+	int32 NumHeroes = 0;
+	if (bRunning || !FParse::Value(FCommandLine::Get(), TEXT("GDLoadTest="), NumHeroes))
+	{
+		return;
+	}
+
+	float DurationSeconds = DefaultDurationSeconds;
+	FParse::Value(FCommandLine::Get(), TEXT("GDLoadTestSeconds="), DurationSeconds);
+
+	StartLoadTest(NumHeroes, DurationSeconds, FParse::Param(FCommandLine::Get(), TEXT("GDLoadTestExit")));
+}
+
+void UGDLoadTestSubsystem::StartLoadTest(int32 NumHeroes, float DurationSeconds, bool bInExitWhenDone)
+{
+	UWorld* World = GetTickableGameObjectWorld();
+	if (!World || World->GetNetMode() == NM_Client || bRunning || NumHeroes <= 0)
+	{
+		return;
+	}
+
+	TArray<FTransform> SpawnCenters;
+	for (TActorIterator<APlayerStart> It(World); It; ++It)
+	{
+		SpawnCenters.Add(It->GetActorTransform());
+	}
+
+	if (SpawnCenters.Num() == 0)
+	{
+		SpawnCenters.Add(FTransform::Identity);
+	}
+
+	for (int32 Index = 0; Index < NumHeroes; Index++)
+	{
+		FTransform SpawnTransform = SpawnCenters[Index % SpawnCenters.Num()];
+		const FVector2D Offset = FMath::RandPointInCircle(SpawnRadius);
+		SpawnTransform.AddToTranslation(FVector(Offset.X, Offset.Y, 0.0f));
+
+		SpawnBot(SpawnTransform);
+	}
+
+	bRunning = true;
+	bExitWhenDone = bInExitWhenDone;
+	StartTime = FPlatformTime::Seconds();
+	EndTime = StartTime + DurationSeconds;
+	FrameTimes.Reset();
+	FrameTimes.Reserve(FMath::CeilToInt(DurationSeconds * 60.0f));
+
+	UGDAbilitySystemComponent::ResetTelemetry(World);
+
+	StartOutBytes.Reset();
+	if (UNetDriver* NetDriver = World->GetNetDriver())
+	{
+		for (UNetConnection* Connection : NetDriver->ClientConnections)
+		{
+			StartOutBytes.Add(Connection, Connection->OutTotalBytes);
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("%s() Started load test with %d of %d heroes for %.0f seconds"), TEXT(__FUNCTION__), Bots.Num(), NumHeroes, DurationSeconds);
+}
+
+void UGDLoadTestSubsystem::StopLoadTest()
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	EndTime = FMath::Min(EndTime, FPlatformTime::Seconds());
+	bRunning = false;
+
+	LogReport();
+
+	for (FGDLoadTestBot& Bot : Bots)
+	{
+		AGDHeroAIController* Controller = Bot.Controller.Get();
+		if (Controller)
+		{
+			APawn* Pawn = Controller->GetPawn();
+			Controller->UnPossess();
+			if (Pawn)
+			{
+				Pawn->Destroy();
+			}
+
+			Controller->Destroy();
+		}
+	}
+
+	Bots.Empty();
+	StartOutBytes.Empty();
+
+	if (bExitWhenDone)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+bool UGDLoadTestSubsystem::IsRunning() const
+{
+	return bRunning;
+}
+
+void UGDLoadTestSubsystem::Deinitialize()
+{
+	Bots.Empty();
+	StartOutBytes.Empty();
+	bRunning = false;
+
+	Super::Deinitialize();
+}
+
+void UGDLoadTestSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_GDLoadTestTick);
+
+	const double Now = FPlatformTime::Seconds();
+
+	// Leave out the time the server spent idle waiting to hit its tick rate
+	FrameTimes.Add(static_cast<float>(FMath::Max(0.0, FApp::GetDeltaTime() - FApp::GetIdleTime()) * 1000.0));
+
+	for (FGDLoadTestBot& Bot : Bots)
+	{
+		UpdateBotInputs(Bot, Now);
+	}
+
+	if (Now >= EndTime)
+	{
+		StopLoadTest();
+	}
+}
+
+bool UGDLoadTestSubsystem::IsTickable() const
+{
+	return !HasAnyFlags(RF_ClassDefaultObject) && bRunning;
+}
+
+TStatId UGDLoadTestSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGDLoadTestSubsystem, STATGROUP_Tickables);
+}
+
+UWorld* UGDLoadTestSubsystem::GetTickableGameObjectWorld() const
+{
+	UGameInstance* GameInstance = GetGameInstance();
+	return GameInstance ? GameInstance->GetWorld() : nullptr;
+}
+
+void UGDLoadTestSubsystem::SpawnBot(const FTransform& SpawnTransform)
+{
+	UWorld* World = GetTickableGameObjectWorld();
+	TSubclassOf<AGDHeroCharacter> LoadedHeroClass = UGDAssetPreloadSubsystem::ResolveClass(this, HeroClass);
+	if (!World || !LoadedHeroClass)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s() Failed to find HeroClass %s."), TEXT(__FUNCTION__), *HeroClass.ToString());
+		return;
+	}
+
+	AGDHeroCharacter* Hero = World->SpawnActorDeferred<AGDHeroCharacter>(LoadedHeroClass, SpawnTransform, nullptr, nullptr,
+		ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+	if (!Hero)
+	{
+		return;
+	}
+
+	// The load test possesses the hero itself
+	Hero->AutoPossessAI = EAutoPossessAI::Disabled;
+	Hero->FinishSpawning(SpawnTransform);
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AGDHeroAIController* Controller = World->SpawnActor<AGDHeroAIController>(AGDHeroAIController::StaticClass(), SpawnTransform, SpawnParameters);
+	if (!Controller)
+	{
+		Hero->Destroy();
+		return;
+	}
+
+	// The AI only moves and aims. Abilities are pressed by the scripted inputs.
+	Controller->AbilityPriority.Reset();
+	Controller->Possess(Hero);
+
+	FGDLoadTestBot Bot;
+	Bot.Controller = Controller;
+	Bot.ReleaseTimes.Init(0.0, Inputs.Num());
+	Bot.ConfirmTimes.Init(0.0, Inputs.Num());
+
+	// Random phase so that the heroes don't all press on the same frame
+	const double Now = FPlatformTime::Seconds();
+	for (const FGDLoadTestInput& Input : Inputs)
+	{
+		Bot.NextPressTimes.Add(Input.PressesPerSecond > 0.0f ? Now + FMath::FRand() / Input.PressesPerSecond : MAX_dbl);
+	}
+
+	Bots.Add(MoveTemp(Bot));
+}
+
+void UGDLoadTestSubsystem::UpdateBotInputs(FGDLoadTestBot& Bot, double Now)
+{
+	AGDHeroAIController* Controller = Bot.Controller.Get();
+	AGDHeroCharacter* Hero = Controller ? Cast<AGDHeroCharacter>(Controller->GetPawn()) : nullptr;
+	UAbilitySystemComponent* ASC = Hero ? Hero->GetAbilitySystemComponent() : nullptr;
+	if (!ASC || !Hero->IsAlive())
+	{
+		return;
+	}
+
+	for (int32 Index = 0; Index < Inputs.Num(); Index++)
+	{
+		const FGDLoadTestInput& Input = Inputs[Index];
+		const int32 InputID = static_cast<int32>(Input.InputID);
+
+		if (Bot.ReleaseTimes[Index] > 0.0 && Now >= Bot.ReleaseTimes[Index])
+		{
+			ASC->AbilityLocalInputReleased(InputID);
+			Bot.ReleaseTimes[Index] = 0.0;
+		}
+
+		if (Bot.ConfirmTimes[Index] > 0.0 && Now >= Bot.ConfirmTimes[Index])
+		{
+			// Heroes without a PlayerInputComponent have no generic confirm input bound, so confirm directly
+			ASC->LocalInputConfirm();
+			Bot.ConfirmTimes[Index] = 0.0;
+		}
+
+		if (Now >= Bot.NextPressTimes[Index])
+		{
+			ASC->AbilityLocalInputPressed(InputID);
+			INC_DWORD_STAT(STAT_GDLoadTestInputsPressed);
+
+			Bot.NextPressTimes[Index] = Now + 1.0 / Input.PressesPerSecond;
+			Bot.ReleaseTimes[Index] = Now + Input.HoldSeconds;
+			Bot.ConfirmTimes[Index] = Input.ConfirmSeconds >= 0.0f ? Now + Input.ConfirmSeconds : 0.0;
+		}
+	}
+}
+
+void UGDLoadTestSubsystem::LogReport() const
+{
+	UWorld* World = GetTickableGameObjectWorld();
+	const double Seconds = FMath::Max(EndTime - StartTime, KINDA_SMALL_NUMBER);
+
+	TArray<float> SortedFrameTimes = FrameTimes;
+	SortedFrameTimes.Sort();
+
+	int32 NumEffectsApplied = 0;
+	for (TObjectIterator<UGDAbilitySystemComponent> It; It; ++It)
+	{
+		if (It->GetWorld() == World)
+		{
+			NumEffectsApplied += It->Telemetry.NumEffectsApplied;
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Load test report: %d heroes for %.1f seconds, %d frames"), Bots.Num(), Seconds, FrameTimes.Num());
+	UE_LOG(LogTemp, Log, TEXT("  Game thread ms p50 %.2f, p90 %.2f, p99 %.2f, max %.2f"), GetPercentile(SortedFrameTimes, 0.5f), GetPercentile(SortedFrameTimes, 0.9f),
+		GetPercentile(SortedFrameTimes, 0.99f), SortedFrameTimes.Num() > 0 ? SortedFrameTimes.Last() : 0.0f);
+	UE_LOG(LogTemp, Log, TEXT("  %.1f GE applications per second"), NumEffectsApplied / Seconds);
+
+	UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+	if (!NetDriver)
+	{
+		return;
+	}
+
+	for (UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		const uint32* StartBytes = StartOutBytes.Find(Connection);
+		const uint32 BytesSent = Connection->OutTotalBytes - (StartBytes ? *StartBytes : 0);
+
+		UE_LOG(LogTemp, Log, TEXT("  %s sent %u bytes (%.2f KB/s)"), *Connection->LowLevelGetRemoteAddress(true), BytesSent, BytesSent / 1024.0 / Seconds);
+	}
+}
@@ -3,11 +3,17 @@
 
 #include "GDPlayerController.h"
 #include "AbilitySystemComponent.h"
+#include "GDAssetPreloadSubsystem.h"
 #include "GDDamageTextWidgetComponent.h"
 #include "GDHeroCharacter.h"
 #include "GDPlayerState.h"
 #include "UI/GDHUDWidget.h"
 
+AGDPlayerController::AGDPlayerController()
+{
+	DamageNumberClass = TSoftClassPtr<UGDDamageTextWidgetComponent>(FSoftObjectPath(TEXT("/Game/GASDocumentation/UI/WC_DamageText.WC_DamageText_C")));
+}
+
 void AGDPlayerController::CreateHUD()
 {
 	// Only create once
@@ -54,12 +60,6 @@ void AGDPlayerController::CreateHUD()
 	UIHUDWidget->SetExperience(PS->GetXP());
 	UIHUDWidget->SetGold(PS->GetGold());
 	UIHUDWidget->SetHeroLevel(PS->GetCharacterLevel());
-
-	DamageNumberClass = StaticLoadClass(UObject::StaticClass(), nullptr, TEXT("/Game/GASDocumentation/UI/WC_DamageText.WC_DamageText_C"));
-	if (!DamageNumberClass)
-	{
-		UE_LOG(LogTemp, Error, TEXT("%s() Failed to find DamageNumberClass. If it was moved, please update the reference location in C++."), TEXT(__FUNCTION__));
-	}
 }
 
 UGDHUDWidget * AGDPlayerController::GetHUD()
@@ -69,7 +69,13 @@ UGDHUDWidget * AGDPlayerController::GetHUD()
 
 void AGDPlayerController::ShowDamageNumber_Implementation(float DamageAmount, AGDCharacterBase * TargetCharacter)
 {
-	UGDDamageTextWidgetComponent* DamageText = NewObject<UGDDamageTextWidgetComponent>(TargetCharacter, DamageNumberClass);
+	TSubclassOf<UGDDamageTextWidgetComponent> LoadedDamageNumberClass = UGDAssetPreloadSubsystem::ResolveClass(this, DamageNumberClass);
+	if (!LoadedDamageNumberClass || !TargetCharacter)
+	{
+		return;
+	}
+
+	UGDDamageTextWidgetComponent* DamageText = NewObject<UGDDamageTextWidgetComponent>(TargetCharacter, LoadedDamageNumberClass);
 	DamageText->RegisterComponent();
 	DamageText->AttachToComponent(TargetCharacter->GetRootComponent(), FAttachmentTransformRules::KeepRelativeTransform);
 	DamageText->SetDamageText(DamageAmount);
@@ -93,6 +99,15 @@ bool AGDPlayerController::SetRespawnCountdown_Validate(float RespawnTimeRemainin
 	return true;
 }
 
+void AGDPlayerController::ClientExecuteGameplayCueBatch_Implementation(const FGDGameplayCueBatch& Batch)
+{
+	UGDGameplayCueBatchSubsystem* BatchSubsystem = UGDGameplayCueBatchSubsystem::Get(this);
+	if (BatchSubsystem)
+	{
+		BatchSubsystem->ExecuteBatch(GetWorld(), Batch);
+	}
+}
+
 // Server only
 void AGDPlayerController::OnPossess(APawn * InPawn)
 {
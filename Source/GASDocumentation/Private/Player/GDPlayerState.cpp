@@ -4,6 +4,7 @@
 #include "GDPlayerState.h"
 #include "Abilities/AttributeSets/GDAttributeSetBase.h"
 #include "GDAbilitySystemComponent.h"
+#include "GDCrowdControlSubsystem.h"
 #include "GDHeroCharacter.h"
 #include "GDPlayerController.h"
 #include "UI/GDFloatingStatusBarWidget.h"
@@ -185,9 +186,17 @@ void AGDPlayerState::HealthChanged(const FOnAttributeChangeData & Data)
 	// Handled in the UI itself using the AsyncTaskAttributeChanged node as an example how to do it in Blueprint
 
 	// If the player died, handle death
-	if (!IsAlive() && !AbilitySystemComponent->HasMatchingGameplayTag(DeadTag))
+	if (Hero && !IsAlive() && !AbilitySystemComponent->HasMatchingGameplayTag(DeadTag))
 	{
-		if (Hero)
+		// Gate right away, the rest of Die() waits for the end of the frame
+		UGDCrowdControlSubsystem::ApplyDeath(AbilitySystemComponent);
+
+		UGDCrowdControlSubsystem* CrowdControl = UGDCrowdControlSubsystem::Get(this);
+		if (CrowdControl)
+		{
+			CrowdControl->QueueDeath(Hero);
+		}
+		else
 		{
 			Hero->Die();
 		}
@@ -391,12 +400,6 @@ void AGDPlayerState::StunTagChanged(const FGameplayTag CallbackTag, int32 NewCou
 {
 	if (NewCount > 0)
 	{
-		FGameplayTagContainer AbilityTagsToCancel;
-		AbilityTagsToCancel.AddTag(FGameplayTag::RequestGameplayTag(FName("Ability")));
-
-		FGameplayTagContainer AbilityTagsToIgnore;
-		AbilityTagsToIgnore.AddTag(FGameplayTag::RequestGameplayTag(FName("Ability.NotCanceledByStun")));
-
-		AbilitySystemComponent->CancelAbilities(&AbilityTagsToCancel, &AbilityTagsToIgnore);
+		UGDCrowdControlSubsystem::ApplyStun(AbilitySystemComponent);
 	}
 }
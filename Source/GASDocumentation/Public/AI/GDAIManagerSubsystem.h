@@ -0,0 +1,74 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "GDAIManagerSubsystem.generated.h"
+
+class AGDCharacterBase;
+class AGDHeroAIController;
+
+/**
+ * Runs the decision making of every AGDHeroAIController on the Server from one tick instead of one tick per controller.
+ * Controllers are visited round-robin under a per frame time budget so that a server full of AI heroes doesn't spend the frame on AI.
+ * Controllers that didn't get a turn this frame are first in line next frame. The list of possible targets is gathered once per frame
+ * and shared by every controller that makes a decision in that frame.
+ */
+UCLASS(Config = Game)
+class GASDOCUMENTATION_API UGDAIManagerSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UGDAIManagerSubsystem();
+
+	// Time in milliseconds per frame that AI decisions are allowed to take
+	UPROPERTY(Config, BlueprintReadWrite, Category = "GASDocumentation|AI")
+	float FrameBudgetMilliseconds;
+
+	// Always make at least this many decisions per frame so that AI still reacts on slow machines
+	UPROPERTY(Config, BlueprintReadWrite, Category = "GASDocumentation|AI")
+	int32 MinDecisionsPerFrame;
+
+	// Seconds between two decisions of the same controller
+	UPROPERTY(Config, BlueprintReadWrite, Category = "GASDocumentation|AI")
+	float DecisionInterval;
+
+	static UGDAIManagerSubsystem* Get(const AActor* Actor);
+
+	void RegisterController(AGDHeroAIController* Controller);
+
+	void UnregisterController(AGDHeroAIController* Controller);
+
+	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|AI")
+	int32 GetNumControllers() const;
+
+	// Implement USubsystem
+	virtual void Deinitialize() override;
+
+	// Implement FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+	struct FGDManagedController
+	{
+		TWeakObjectPtr<AGDHeroAIController> Controller;
+		double NextDecisionTime;
+	};
+
+	TArray<FGDManagedController> Controllers;
+
+	// Index in Controllers of the next controller to get a turn
+	int32 NextControllerIndex;
+
+	// Living characters in the world. Only valid for the frame that it was gathered in.
+	TArray<AGDCharacterBase*> TargetCandidates;
+	uint64 TargetCandidatesFrame;
+
+	const TArray<AGDCharacterBase*>& GetTargetCandidates();
+};
@@ -4,10 +4,14 @@
 
 #include "CoreMinimal.h"
 #include "AIController.h"
+#include "GASDocumentation.h"
 #include "GDHeroAIController.generated.h"
 
+class AGDCharacterBase;
+
 /**
- * 
+ * Native AI brain for heroes. Picks the closest living minion as its target, moves into range and activates its abilities by
+ * EGDAbilityInputID in priority order. Decisions are made on the Server by the UGDAIManagerSubsystem, not in this controller's tick.
  */
 UCLASS()
 class GASDOCUMENTATION_API AGDHeroAIController : public AAIController
@@ -16,4 +20,36 @@ class GASDOCUMENTATION_API AGDHeroAIController : public AAIController
 	
 public:
 	AGDHeroAIController();
+
+	// Abilities are tried in this order. The first one that activates ends the decision.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GASDocumentation|AI")
+	TArray<EGDAbilityInputID> AbilityPriority;
+
+	// Targets further away than this are ignored
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GASDocumentation|AI")
+	float AcquireRadius;
+
+	// Abilities are only activated when the target is within this range. Otherwise the hero moves towards the target.
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "GASDocumentation|AI")
+	float AttackRange;
+
+	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|AI")
+	AGDCharacterBase* GetTarget() const;
+
+	// Called by the UGDAIManagerSubsystem. Candidates are the living characters in the world.
+	void MakeDecision(const TArray<AGDCharacterBase*>& Candidates);
+
+protected:
+	TWeakObjectPtr<AGDCharacterBase> Target;
+
+	virtual void OnPossess(APawn* InPawn) override;
+	virtual void OnUnPossess() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Keeps the current target while it's alive and in range, otherwise picks the closest hostile candidate
+	AGDCharacterBase* UpdateTarget(const AGDCharacterBase* Hero, const TArray<AGDCharacterBase*>& Candidates);
+
+	virtual bool IsHostile(const AGDCharacterBase* Hero, const AGDCharacterBase* Candidate) const;
+
+	bool TryActivateAbilityByPriority(AGDCharacterBase* Hero);
 };
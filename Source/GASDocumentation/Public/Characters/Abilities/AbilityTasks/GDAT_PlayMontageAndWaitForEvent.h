@@ -11,6 +11,9 @@ class UGDAbilitySystemComponent;
 /** Delegate type used, EventTag and Payload may be empty if it came from the montage callbacks */
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FGDPlayMontageAndWaitForEventDelegate, FGameplayTag, EventTag, FGameplayEventData, EventData);
 
+/** Native version for C++ abilities. EventData is passed by reference instead of copied and its EventTag may be empty, use the EventTag parameter. */
+DECLARE_MULTICAST_DELEGATE_TwoParams(FGDPlayMontageAndWaitForEventNativeDelegate, FGameplayTag /*EventTag*/, const FGameplayEventData& /*EventData*/);
+
 /**
  * This task combines PlayMontageAndWait and WaitForEvent into one task, so you can wait for multiple types of activations such as from a melee combo
  * Much of this code is copied from one of those two ability tasks
@@ -55,6 +58,16 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FGDPlayMontageAndWaitForEventDelegate EventReceived;
 
+	/**
+	 * Native versions of the delegates above, broadcast right before them. C++ abilities should bind to these to avoid copying
+	 * the event payload and the reflection cost of dynamic delegates. The dynamic delegates are only broadcast if something is bound.
+	 */
+	FGDPlayMontageAndWaitForEventNativeDelegate OnCompletedNative;
+	FGDPlayMontageAndWaitForEventNativeDelegate OnBlendOutNative;
+	FGDPlayMontageAndWaitForEventNativeDelegate OnInterruptedNative;
+	FGDPlayMontageAndWaitForEventNativeDelegate OnCancelledNative;
+	FGDPlayMontageAndWaitForEventNativeDelegate EventReceivedNative;
+
 	/**
 	 * Play a montage and wait for it end. If a gameplay event happens that matches EventTags (or EventTags is empty), the EventReceived delegate will fire with a tag and event data.
 	 * If StopWhenAbilityEnds is true, this montage will be aborted if the ability ends normally. It is always stopped when the ability is explicitly cancelled.
@@ -67,6 +80,8 @@ public:
 	 * @param Rate Change to play the montage faster or slower
 	 * @param bStopWhenAbilityEnds If true, this montage will be aborted if the ability ends normally. It is always stopped when the ability is explicitly cancelled
 	 * @param AnimRootMotionTranslationScale Change to modify size of root motion or set to 0 to block it entirely
+	 * @param bExactEventTagMatch If true, only events whose tag exactly matches one of the EventTags are received. They are routed to this task
+	 *        directly by the ASC instead of being checked against EventTags for every event. Ignored if EventTags is empty.
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Ability|Tasks", meta = (HidePin = "OwningAbility", DefaultToSelf = "OwningAbility", BlueprintInternalUseOnly = "TRUE"))
 	static UGDAT_PlayMontageAndWaitForEvent* PlayMontageAndWaitForEvent(
@@ -77,7 +92,17 @@ public:
 			float Rate = 1.f,
 			FName StartSection = NAME_None,
 			bool bStopWhenAbilityEnds = true,
-			float AnimRootMotionTranslationScale = 1.f);
+			float AnimRootMotionTranslationScale = 1.f,
+			bool bExactEventTagMatch = false);
+
+	/**
+	 * Plays a montage again on this task instead of creating a new task, for abilities that fire many times per activation.
+	 * Can be called from this task's own delegates. Event subscriptions and delegate bindings are kept, callbacks from the
+	 * previous montage are ignored. The task will not end from the previous montage ending if this is called from OnCompleted.
+	 * @param NewMontageToPlay Montage to play, or the current montage if null
+	 * @return True if the montage started playing. If false, the caller should end the task or ability.
+	 */
+	bool RestartMontage(UAnimMontage* NewMontageToPlay = nullptr, float NewRate = 1.f, FName NewStartSection = NAME_None);
 
 private:
 	/** Montage that is playing */
@@ -104,20 +129,40 @@ private:
 	UPROPERTY()
 	bool bStopWhenAbilityEnds;
 
+	/** Whether EventTags are subscribed to individually with exact matching */
+	UPROPERTY()
+	bool bExactEventTagMatch;
+
 	/** Checks if the ability is playing a montage and stops that montage, returns true if a montage was stopped, false if not. */
 	bool StopPlayingMontage();
 
 	/** Returns our ability system component */
 	UGDAbilitySystemComponent* GetTargetASC();
 
-	void OnMontageBlendingOut(UAnimMontage* Montage, bool bInterrupted);
+	/** Plays MontageToPlay and binds to its callbacks, returns true if the montage started playing */
+	bool PlayMontage(UGDAbilitySystemComponent* GDAbilitySystemComponent, UAnimInstance* AnimInstance);
+
+	// Incremented every time a montage is played so that callbacks from a restarted montage can be ignored
+	uint32 MontagePlaySerial;
+
+	void OnMontageBlendingOut(UAnimMontage* Montage, bool bInterrupted, uint32 PlaySerial);
 	void OnAbilityCancelled();
-	void OnMontageEnded(UAnimMontage* Montage, bool bInterrupted);
+	void OnMontageEnded(UAnimMontage* Montage, bool bInterrupted, uint32 PlaySerial);
 	void OnGameplayEvent(FGameplayTag EventTag, const FGameplayEventData* Payload);
+	// EventTag is bound per delegate since payloads sent from anim notifies don't have their EventTag set
+	void OnExactGameplayEvent(const FGameplayEventData* Payload, FGameplayTag EventTag);
+
+	void BroadcastEvent(FGameplayTag EventTag, const FGameplayEventData& EventData);
+
+	// Broadcasts a montage state change that has no event tag or payload
+	void BroadcastMontageState(FGDPlayMontageAndWaitForEventDelegate& Delegate, FGDPlayMontageAndWaitForEventNativeDelegate& NativeDelegate);
+
+	void RemoveEventDelegates();
 
 	FOnMontageBlendingOutStarted BlendingOutDelegate;
 	FOnMontageEnded MontageEndedDelegate;
 	FDelegateHandle CancelledHandle;
 	FDelegateHandle EventHandle;
+	TArray<TPair<FGameplayTag, FDelegateHandle>> ExactEventHandles;
 	
 };
@@ -31,14 +31,46 @@ public:
 	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true"))
 	static UAsyncTaskAttributeChanged* ListenForAttributesChange(UAbilitySystemComponent* AbilitySystemComponent, TArray<FGameplayAttribute> Attributes);
 
+	// Listens for attributes changing, but broadcasts at most once per Attribute per frame.
+	// OldValue is the value at the first change this frame and NewValue is the value after the last change.
+	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true"))
+	static UAsyncTaskAttributeChanged* ListenForAttributesChangeCoalesced(UAbilitySystemComponent* AbilitySystemComponent, TArray<FGameplayAttribute> Attributes);
+
+	// You must call this function manually when you want the AsyncTask to end.
+	// For UMG Widgets, you would call it in the Widget's Destruct event.
+	UFUNCTION(BlueprintCallable)
+	void EndTask();
+
 	virtual void BeginDestroy() override;
 
 protected:
+	friend class UGDAbilitySystemComponent;
+
 	UPROPERTY()
 	UAbilitySystemComponent* ASC;
 
 	FGameplayAttribute AttributeToListenFor;
 	TArray<FGameplayAttribute> AttributesToListenFor;
 
+	bool CoalesceChanges;
+
+	struct FPendingAttributeChange
+	{
+		FGameplayAttribute Attribute;
+		float NewValue;
+		float OldValue;
+	};
+
+	// Changes waiting for the next tick when coalescing
+	TArray<FPendingAttributeChange> PendingChanges;
+
+	FTimerHandle FlushPendingChangesTimerHandle;
+
+	// GDAbilitySystemComponents fan out to their listeners from one delegate per Attribute. Other ASCs are bound to directly.
+	void StartListening();
+	void StopListening();
+
 	void AttributeChanged(const FOnAttributeChangeData& Data);
+
+	void FlushPendingChanges();
 };
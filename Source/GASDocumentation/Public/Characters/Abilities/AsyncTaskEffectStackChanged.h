@@ -24,7 +24,17 @@ class GASDOCUMENTATION_API UAsyncTaskEffectStackChanged : public UBlueprintAsync
 	UFUNCTION(BlueprintCallable, meta = (BlueprintInternalUseOnly = "true"))
 	static UAsyncTaskEffectStackChanged* ListenForGameplayEffectStackChange(UAbilitySystemComponent* AbilitySystemComponent, FGameplayTag EffectGameplayTag);
 
+	// You must call this function manually when you want the AsyncTask to end.
+	// For UMG Widgets, you would call it in the Widget's Destruct event.
+	UFUNCTION(BlueprintCallable)
+	void EndTask();
+
+	virtual void BeginDestroy() override;
+
 protected:
+	// GDAbilitySystemComponents notify through their effect tag index
+	friend class UGDAbilitySystemComponent;
+
 	UPROPERTY()
 	UAbilitySystemComponent* ASC;
 
@@ -34,4 +44,6 @@ protected:
 	virtual void OnRemoveGameplayEffectCallback(const FActiveGameplayEffect& EffectRemoved);
 
 	virtual void GameplayEffectStackChanged(FActiveGameplayEffectHandle EffectHandle, int32 NewStackCount, int32 PreviousStackCount);
+
+	void StopListening();
 };
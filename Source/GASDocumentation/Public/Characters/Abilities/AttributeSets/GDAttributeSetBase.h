@@ -14,6 +14,8 @@
 	GAMEPLAYATTRIBUTE_VALUE_SETTER(PropertyName) \
 	GAMEPLAYATTRIBUTE_VALUE_INITTER(PropertyName)
 
+struct FGDAttributeRule;
+
 /**
  * 
  */
@@ -119,6 +121,41 @@ public:
 	ATTRIBUTE_ACCESSORS(UGDAttributeSetBase, GoldBounty);
 
 protected:
+	friend struct FGDAttributeRuleTable;
+	friend class FGDScopedMaxAttributeRescale;
+
+	struct FGDPendingMaxAttributeRescale
+	{
+		FGameplayAttribute AffectedAttribute;
+
+		// Max value before the first change in the scope and after the last one
+		float OldMaxValue;
+		float NewMaxValue;
+	};
+
+	// Open FGDScopedMaxAttributeRescales. Max attribute changes are queued instead of rescaling right away while this is above 0.
+	int32 MaxAttributeRescaleScopeDepth = 0;
+
+	TArray<FGDPendingMaxAttributeRescale, TInlineAllocator<3>> PendingMaxAttributeRescales;
+
+	// Current attributes executed inside a scope. They're clamped to their max attribute after the deferred rescales.
+	TArray<FGameplayAttribute, TInlineAllocator<3>> PendingMaxAttributeClamps;
+
+	void QueueMaxAttributeRescale(const FGameplayAttribute& AffectedAttribute, const FGameplayAttribute& MaxAttribute, float NewMaxValue);
+
+	// Rescales each queued current attribute once, from its max value before the scope to its max value after it, then clamps
+	// the queued current attributes
+	void FlushMaxAttributeRescales();
+
+	// Clamps a current attribute like Health between 0 and its max attribute
+	void ClampToMaxAttribute(const FGameplayAttribute& Attribute, const FGameplayAttribute& MaxAttribute);
+
+	// Rule for the attribute (clamps, max rescaling, execute handler) or null if it has none. Indexed, not a chain of compares.
+	static const FGDAttributeRule* FindAttributeRule(const FGameplayAttribute& Attribute);
+
+	// Applies the Damage meta attribute to Health, plays hit reacts and awards bounties
+	void HandleDamageExecuted(const FGameplayEffectModCallbackData& Data);
+
 	// Helper function to proportionally adjust the value of an attribute when it's associated max attribute changes.
 	// (i.e. When MaxHealth increases, Health increases by an amount that maintains the same percentage as before)
 	void AdjustAttributeForMaxChange(FGameplayAttributeData& AffectedAttribute, const FGameplayAttributeData& MaxAttribute, float NewMaxValue, const FGameplayAttribute& AffectedAttributeProperty);
@@ -181,3 +218,19 @@ private:
 	FGameplayTag HitDirectionRightTag;
 	FGameplayTag HitDirectionLeftTag;
 };
+
+/**
+ * Defers the proportional current value adjustments of max attribute changes (see AdjustAttributeForMaxChange) to the end of the
+ * outermost scope instead of doing a nested attribute modification inside PreAttributeChange. A current attribute is adjusted once
+ * per scope no matter how many times its max changed, like a level up GameplayEffect with several modifiers.
+ * Clamping Health, Mana and Stamina to their max in PostGameplayEffectExecute is deferred too and runs after the rescales.
+ */
+class GASDOCUMENTATION_API FGDScopedMaxAttributeRescale
+{
+public:
+	FGDScopedMaxAttributeRescale(UAbilitySystemComponent* AbilitySystemComponent);
+	~FGDScopedMaxAttributeRescale();
+
+private:
+	TWeakObjectPtr<UGDAttributeSetBase> AttributeSet;
+};
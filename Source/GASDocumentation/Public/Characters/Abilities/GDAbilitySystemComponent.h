@@ -8,6 +8,50 @@
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FReceivedDamageDelegate, UGDAbilitySystemComponent*, SourceASC, float, UnmitigatedDamage, float, MitigatedDamage);
 
+// Server side cost of the GAS work done for one ASC's owner. Dumped by GD.Telemetry.Dump.
+struct FGDCombatTelemetry
+{
+	uint64 PostGameplayEffectExecuteCycles = 0;
+	uint64 DamageExecutionCycles = 0;
+	uint64 DieCycles = 0;
+	int32 NumPostGameplayEffectExecutes = 0;
+	int32 NumDamageExecutions = 0;
+	int32 NumEffectsApplied = 0;
+	int32 NumAbilitiesActivated = 0;
+
+	// EGDAbilityInputID to the number of activations
+	TMap<uint8, int32> AbilityActivationsByInputID;
+
+	// Start of the window that GE applications per second are measured over
+	double StartTime = 0.0;
+
+	uint64 GetTotalCycles() const
+	{
+		return PostGameplayEffectExecuteCycles + DamageExecutionCycles + DieCycles;
+	}
+};
+
+// Adds the time spent in its scope to a FGDCombatTelemetry counter. Does nothing if Cycles is null.
+struct FGDCombatTelemetryScope
+{
+	FGDCombatTelemetryScope(uint64* InCycles)
+		: Cycles(InCycles), StartCycles(InCycles ? FPlatformTime::Cycles64() : 0)
+	{
+	}
+
+	~FGDCombatTelemetryScope()
+	{
+		if (Cycles)
+		{
+			*Cycles += FPlatformTime::Cycles64() - StartCycles;
+		}
+	}
+
+private:
+	uint64* Cycles;
+	uint64 StartCycles;
+};
+
 /**
  * 
  */
@@ -24,4 +68,87 @@ public:
 
 	// Called from GDDamageExecCalculation. Broadcasts on ReceivedDamage whenever this ASC receives damage.
 	virtual void ReceiveDamage(UGDAbilitySystemComponent* SourceASC, float UnmitigatedDamage, float MitigatedDamage);
+
+	// Registers the Listener for changes to the Attribute. The ASC binds to each Attribute's value change delegate once
+	// no matter how many listeners there are and fans out to them.
+	void AddAttributeChangeListener(const FGameplayAttribute& Attribute, class UAsyncTaskAttributeChanged* Listener);
+
+	// Removes the Listener from every Attribute that it listens to. Safe to call while the listeners are being notified.
+	void RemoveAttributeChangeListener(class UAsyncTaskAttributeChanged* Listener);
+
+	// Registers the Listener for stack changes (including add and remove) of active GameplayEffects that have the EffectTag as an
+	// exact Asset or Granted tag. Only listened to tags are indexed, so effects without them cost one map lookup per tag.
+	void AddEffectStackChangeListener(const FGameplayTag& EffectTag, class UAsyncTaskEffectStackChanged* Listener);
+
+	void RemoveEffectStackChangeListener(class UAsyncTaskEffectStackChanged* Listener);
+
+	// Total stack count of the active GameplayEffects that have the EffectTag. Only valid for tags that have a stack change listener.
+	int32 GetIndexedEffectStackCount(const FGameplayTag& EffectTag) const;
+
+	FGDCombatTelemetry Telemetry;
+
+	// Logs the MaxRows ASCs in the World that cost the most server time, plus ability activations per input and GE applications per second
+	static void DumpTelemetry(UWorld* World, int32 MaxRows);
+
+	static void ResetTelemetry(UWorld* World);
+
+	// Max attribute rescaling is deferred until the whole spec has been applied
+	virtual FActiveGameplayEffectHandle ApplyGameplayEffectSpecToSelf(const FGameplayEffectSpec& GameplayEffect, FPredictionKey PredictionKey = FPredictionKey()) override;
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void NotifyAbilityActivated(const FGameplayAbilitySpecHandle Handle, UGameplayAbility* Ability) override;
+
+protected:
+	struct FGDAttributeChangeListeners
+	{
+		FGameplayAttribute Attribute;
+		FDelegateHandle DelegateHandle;
+		TArray<TWeakObjectPtr<class UAsyncTaskAttributeChanged>> Listeners;
+		bool bHasRemovedListeners = false;
+	};
+
+	// One entry per Attribute that has ever been listened to. Entries are never removed so that their index can be bound as the delegate payload.
+	TArray<FGDAttributeChangeListeners> AttributeChangeListeners;
+
+	int32 AttributeChangeBroadcastDepth = 0;
+
+	void NotifyAttributeChangeListeners(const FOnAttributeChangeData& Data, int32 AttributeChangeListenersIndex);
+
+	struct FGDIndexedEffect
+	{
+		FActiveGameplayEffectHandle Handle;
+		int32 StackCount;
+	};
+
+	struct FGDEffectTagIndexEntry
+	{
+		TArray<FGDIndexedEffect> Effects;
+		TArray<TWeakObjectPtr<class UAsyncTaskEffectStackChanged>> Listeners;
+	};
+
+	// Listened to effect tags to the active effects that have them
+	TMap<FGameplayTag, FGDEffectTagIndexEntry> EffectTagIndex;
+
+	// Indexed active effects to their listened to tags so that removal and stack changes don't need to look at the Spec's tags again
+	TMap<FActiveGameplayEffectHandle, TArray<FGameplayTag, TInlineAllocator<2>>> IndexedEffectTags;
+
+	FDelegateHandle EffectTagIndexAddedDelegateHandle;
+	FDelegateHandle EffectTagIndexRemovedDelegateHandle;
+
+	void IndexActiveEffect(const FGameplayEffectSpec& Spec, FActiveGameplayEffectHandle ActiveHandle, int32 StackCount);
+	void IndexTagsFromContainer(const FGameplayTagContainer& Tags, FActiveGameplayEffectHandle ActiveHandle, int32 StackCount, bool& bOutIndexed);
+
+	void OnEffectTagIndexEffectAdded(UAbilitySystemComponent* Target, const FGameplayEffectSpec& SpecApplied, FActiveGameplayEffectHandle ActiveHandle);
+	void OnEffectTagIndexEffectRemoved(const FActiveGameplayEffect& EffectRemoved);
+	void OnEffectTagIndexStackChanged(FActiveGameplayEffectHandle EffectHandle, int32 NewStackCount, int32 PreviousStackCount);
+
+	void NotifyEffectStackChangeListeners(const FGameplayTag& EffectTag, FActiveGameplayEffectHandle EffectHandle, int32 NewStackCount, int32 PreviousStackCount);
+
+	// Removes cleared listeners and unbinds from Attributes without listeners. Deferred while listeners are being notified.
+	void CompactAttributeChangeListeners(FGDAttributeChangeListeners& Entry);
+
+	void OnTelemetryEffectApplied(UAbilitySystemComponent* Target, const FGameplayEffectSpec& SpecApplied, FActiveGameplayEffectHandle ActiveHandle);
 };
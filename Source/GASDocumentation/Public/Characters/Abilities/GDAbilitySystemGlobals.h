@@ -0,0 +1,19 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AbilitySystemGlobals.h"
+#include "GDAbilitySystemGlobals.generated.h"
+
+/**
+ * Allocates FGDGameplayEffectContexts for every GameplayEffect. Set as the AbilitySystemGlobalsClassName in DefaultGame.ini.
+ */
+UCLASS()
+class GASDOCUMENTATION_API UGDAbilitySystemGlobals : public UAbilitySystemGlobals
+{
+	GENERATED_BODY()
+
+public:
+	virtual FGameplayEffectContext* AllocGameplayEffectContext() const override;
+};
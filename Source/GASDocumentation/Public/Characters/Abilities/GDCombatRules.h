@@ -0,0 +1,91 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FGDDamageFormula;
+
+// Result of applying damage to a combatant's health
+struct FGDDamageOutcome
+{
+	float NewHealth;
+	bool bWasAlive;
+
+	// Was alive before the damage and isn't anymore
+	bool bKilled;
+
+	// The source gets the target's XP and Gold bounties. Never for killing yourself.
+	bool bAwardBounty;
+};
+
+/**
+ * The combat rules shared by GDAttributeSetBase, the mass minions and the offline combat simulator: armor mitigation, clamping
+ * health after damage, death and bounties. Plain C++ without UObjects so that they can run on any thread.
+ */
+class GASDOCUMENTATION_API FGDCombatRules
+{
+public:
+	// Uses the Formula if it is valid, otherwise MitigateDamageNative()
+	static float MitigateDamage(const FGDDamageFormula* Formula, float UnmitigatedDamage, float Armor);
+
+	// The built in mitigation formula: Damage * (100 / (100 + Armor))
+	static float MitigateDamageNative(float UnmitigatedDamage, float Armor);
+
+	static FGDDamageOutcome ApplyDamage(float Health, float MaxHealth, float Damage, bool bSelfInflicted);
+};
+
+// Stats of one side of a simulated fight
+struct FGDCombatantStats
+{
+	float MaxHealth = 100.0f;
+	float Armor = 0.0f;
+
+	// Unmitigated damage per attack
+	float Damage = 10.0f;
+
+	// Each attack's damage is randomly scaled by up to +/- this fraction
+	float DamageVariance = 0.0f;
+
+	float AttacksPerSecond = 1.0f;
+	float XPBounty = 0.0f;
+	float GoldBounty = 0.0f;
+};
+
+struct FGDCombatSimulationResult
+{
+	int32 NumFights = 0;
+	int32 WinsA = 0;
+	int32 WinsB = 0;
+
+	// Nobody died within FGDCombatSimulator::MaxFightSeconds
+	int32 Draws = 0;
+
+	// Sums over the fights that weren't draws
+	double TotalFightSeconds = 0.0;
+	double TotalWinnerHealthFraction = 0.0;
+
+	double XPAwardedA = 0.0;
+	double GoldAwardedA = 0.0;
+	double XPAwardedB = 0.0;
+	double GoldAwardedB = 0.0;
+
+	void Merge(const FGDCombatSimulationResult& Other);
+};
+
+/**
+ * Monte Carlo simulator of one on one fights using FGDCombatRules. Fights are split into fixed size chunks with their own random
+ * streams that run in a ParallelFor, so a run with the same seed gives the same result on any number of cores.
+ */
+class GASDOCUMENTATION_API FGDCombatSimulator
+{
+public:
+	static const float MaxFightSeconds;
+	static const int32 FightsPerChunk = 4096;
+
+	// Runs one fight to the death. A attacks first when both attack at the same time.
+	static void SimulateFight(const FGDCombatantStats& A, const FGDCombatantStats& B, const FGDDamageFormula* Formula, FRandomStream& RandomStream,
+		FGDCombatSimulationResult& InOutResult);
+
+	static FGDCombatSimulationResult Run(const FGDCombatantStats& A, const FGDCombatantStats& B, const FGDDamageFormula* Formula, int32 NumFights, int32 Seed);
+};
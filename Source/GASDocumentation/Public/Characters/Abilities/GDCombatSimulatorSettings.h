@@ -0,0 +1,60 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GDCombatRules.h"
+#include "UObject/NoExportTypes.h"
+#include "GDCombatSimulatorSettings.generated.h"
+
+// Named stats for the combat simulator, like a hero or a minion at a given level
+USTRUCT()
+struct FGDCombatProfile
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Config)
+	FName Name;
+
+	UPROPERTY(Config)
+	float MaxHealth = 100.0f;
+
+	UPROPERTY(Config)
+	float Armor = 0.0f;
+
+	UPROPERTY(Config)
+	float Damage = 10.0f;
+
+	UPROPERTY(Config)
+	float DamageVariance = 0.0f;
+
+	UPROPERTY(Config)
+	float AttacksPerSecond = 1.0f;
+
+	UPROPERTY(Config)
+	float XPBounty = 0.0f;
+
+	UPROPERTY(Config)
+	float GoldBounty = 0.0f;
+
+	FGDCombatantStats ToCombatantStats() const;
+};
+
+/**
+ * Combat profiles for GD.CombatSim.Run, which pits two of them against each other in an offline Monte Carlo simulation using the
+ * same mitigation formula (GDDamageExecCalculation's MitigationFormula) and damage rules as the game.
+ * Edit the profiles in DefaultGame.ini and reload them with GD.CombatSim.Reload (and GD.DamageFormula.Reload) without restarting.
+ */
+UCLASS(Config = Game)
+class GASDOCUMENTATION_API UGDCombatSimulatorSettings : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(Config)
+	TArray<FGDCombatProfile> Profiles;
+
+	const FGDCombatProfile* FindProfile(FName Name) const;
+
+	static void RunSimulation(FName ProfileA, FName ProfileB, int32 NumFights, int32 Seed);
+};
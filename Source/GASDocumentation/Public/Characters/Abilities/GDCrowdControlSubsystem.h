@@ -0,0 +1,54 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "GDCrowdControlSubsystem.generated.h"
+
+class AGDCharacterBase;
+class UAbilitySystemComponent;
+
+/**
+ * Applies crowd control gating (stun, death) immediately and defers the rest of a death to once per frame.
+ * Cancelling abilities and adding the State.Dead blocking tag happen inside the tag or attribute change callback so that
+ * nothing can activate or keep running on a stunned or dead ASC. Die() (removing abilities and effects, collision, the death
+ * montage, OnCharacterDied and the combat log) is queued and resolved at the end of the frame in the order the deaths were queued
+ * so that a mass kill is deterministic. The cancel and ignore tag containers for stuns are built once instead of on every stun.
+ */
+UCLASS()
+class GASDOCUMENTATION_API UGDCrowdControlSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	static UGDCrowdControlSubsystem* Get(const AActor* Actor);
+
+	// Cancels the ASC's abilities except Ability.NotCanceledByStun. The stun tag itself blocks new activations. Does not need a subsystem.
+	static void ApplyStun(UAbilitySystemComponent* AbilitySystemComponent);
+
+	// Cancels all of the ASC's abilities and adds State.Dead so that nothing activates before Die() runs. Does not need a subsystem.
+	static void ApplyDeath(UAbilitySystemComponent* AbilitySystemComponent);
+
+	// Calls Die() on the Character at the end of the frame. Call ApplyDeath() first; its State.Dead tag keeps a Character from being queued twice.
+	void QueueDeath(AGDCharacterBase* Character);
+
+	// Resolves everything queued so far. Called automatically once per frame.
+	void ResolvePendingDeaths();
+
+	int32 GetNumPendingDeaths() const;
+
+	// Implement USubsystem
+	virtual void Deinitialize() override;
+
+	// Implement FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+	// In the order that the deaths were queued this frame
+	TArray<TWeakObjectPtr<AGDCharacterBase>> PendingDeaths;
+};
@@ -6,10 +6,19 @@
 #include "GameplayEffectExecutionCalculation.h"
 #include "GDDamageExecCalculation.generated.h"
 
+class FGDDamageFormula;
+
+// One damage application in a UGDDamageExecCalculation::ApplyDamageBatch()
+struct FGDDamageBatchEntry
+{
+	FGameplayEffectSpecHandle SpecHandle;
+	TWeakObjectPtr<AActor> TargetActor;
+};
+
 /**
  * 
  */
-UCLASS()
+UCLASS(Config = Game)
 class GASDOCUMENTATION_API UGDDamageExecCalculation : public UGameplayEffectExecutionCalculation
 {
 	GENERATED_BODY()
@@ -18,4 +27,27 @@ public:
 	UGDDamageExecCalculation();
 
 	virtual void Execute_Implementation(const FGameplayEffectCustomExecutionParameters& ExecutionParams, OUT FGameplayEffectCustomExecutionOutput& OutExecutionOutput) const override;
+
+	// Armor mitigation shared with targets that don't have an AbilitySystemComponent, like mass minions
+	static float CalculateMitigatedDamage(float UnmitigatedDamage, float Armor);
+
+	// Applies damage specs to many targets at once, like for AoE, in the order of Entries. Targets with an AbilitySystemComponent
+	// get the spec applied as is and are mitigated by the exec calc. Mass minions are mitigated against the attribute table's
+	// Armor, for instant damage specs only. The specs aren't modified. Server only.
+	static void ApplyDamageBatch(const TArray<FGDDamageBatchEntry>& Entries);
+
+	// Armor mitigation formula, see FGDDamageFormula. Falls back to Damage * (100 / (100 + Armor)) if it doesn't compile.
+	UPROPERTY(Config)
+	FString MitigationFormula;
+
+	// Compiles MitigationFormula from the CDO's config. Called at startup and by GD.DamageFormula.Reload.
+	static void CompileMitigationFormula();
+
+	// The compiled MitigationFormula. Invalid if it didn't compile.
+	static const FGDDamageFormula& GetMitigationFormula();
+
+	// Times the compiled formula against the hand written C++ formula over NumSamples random inputs
+	static void RunFormulaBenchmark(int32 NumSamples);
+
+	virtual void PostInitProperties() override;
 };
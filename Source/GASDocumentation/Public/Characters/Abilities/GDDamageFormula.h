@@ -0,0 +1,59 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * A damage formula authored as text in config, like "Damage * (100 / (100 + Armor))", compiled once into flat postfix
+ * instructions that are evaluated with a small fixed size stack. No UObjects, allocations or Blueprint calls at evaluation
+ * time, so it is safe to evaluate from the damage batch's worker threads.
+ * Supports numbers, the variables below, + - * / with the usual precedence, unary minus, parentheses, min(a, b) and max(a, b).
+ */
+class GASDOCUMENTATION_API FGDDamageFormula
+{
+public:
+	enum EVariable : uint8
+	{
+		Damage,
+		Armor,
+		NumVariables
+	};
+
+	static const int32 MaxStackDepth = 16;
+
+	// Returns false and leaves the formula invalid if the Expression doesn't parse
+	bool Compile(const FString& Expression, FString& OutError);
+
+	bool IsValid() const;
+
+	// Variables is indexed by EVariable and must have NumVariables entries
+	float Evaluate(const float* Variables) const;
+
+	int32 GetNumInstructions() const;
+
+private:
+	enum class EOp : uint8
+	{
+		Constant,
+		Variable,
+		Add,
+		Subtract,
+		Multiply,
+		Divide,
+		Negate,
+		Min,
+		Max
+	};
+
+	struct FInstruction
+	{
+		EOp Op;
+		uint8 VariableIndex;
+		float Constant;
+	};
+
+	TArray<FInstruction> Instructions;
+
+	friend class FGDDamageFormulaParser;
+};
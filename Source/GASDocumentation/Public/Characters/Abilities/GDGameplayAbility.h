@@ -34,4 +34,33 @@ public:
 	// If an ability is marked as 'ActivateAbilityOnGranted', activate them immediately when given here
 	// Epic's comment: Projects may want to initiate passives or do other "BeginPlay" type of logic here.
 	virtual void OnAvatarSet(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec) override;
+
+	virtual void OnRemoveAbility(const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilitySpec& Spec) override;
+
+	/**
+	 * Like MakeOutgoingGameplayEffectSpec() but hands out the same spec again, per effect class and level, once nothing else holds
+	 * the handle it returned last time. A reused spec skips the allocation and the modifier and attribute capture setup from the
+	 * GameplayEffect definition. It gets a new EffectContext, which recaptures the source, and starts with only the ability spec's
+	 * SetByCaller values and tags. Don't keep the returned handle around longer than needed or a new spec is allocated every time.
+	 * Falls back to MakeOutgoingGameplayEffectSpec() for non-instanced abilities.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Ability")
+	FGameplayEffectSpecHandle MakeCachedOutgoingGameplayEffectSpec(TSubclassOf<UGameplayEffect> GameplayEffectClass, float Level = 1.f);
+
+	void ClearCachedEffectSpecs();
+
+	// True if the instigating client plays this ability's impact GameplayCues itself, so the GDGameplayCueBatchSubsystem
+	// doesn't send them back to it
+	virtual bool PredictsImpactCues() const;
+
+protected:
+	struct FGDCachedEffectSpec
+	{
+		TWeakObjectPtr<UClass> EffectClass;
+		float Level;
+		FGameplayEffectSpecHandle SpecHandle;
+	};
+
+	// One per GameplayEffect class and level, so only a few per ability. Cleared when the avatar changes or the ability is removed.
+	TArray<FGDCachedEffectSpec> CachedEffectSpecs;
 };
@@ -0,0 +1,149 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "GameplayTagContainer.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "GDGameplayCueBatchSubsystem.generated.h"
+
+class AGDPlayerController;
+class UAbilitySystemComponent;
+class UParticleSystem;
+struct FGameplayCueParameters;
+struct FPredictionKey;
+
+// One executed GameplayCue or cosmetic emitter in a FGDGameplayCueBatch
+USTRUCT()
+struct GASDOCUMENTATION_API FGDBatchedGameplayCue
+{
+	GENERATED_BODY()
+
+	// Executed on Target through the GameplayCueManager if set
+	UPROPERTY()
+	FGameplayTag CueTag;
+
+	// Spawned at Location if there is no CueTag
+	UPROPERTY()
+	UParticleSystem* Emitter = nullptr;
+
+	UPROPERTY()
+	AActor* Target = nullptr;
+
+	UPROPERTY()
+	AActor* Instigator = nullptr;
+
+	UPROPERTY()
+	AActor* EffectCauser = nullptr;
+
+	UPROPERTY()
+	FVector_NetQuantize Location = FVector::ZeroVector;
+
+	UPROPERTY()
+	FVector_NetQuantizeNormal Normal = FVector::ZeroVector;
+};
+
+/**
+ * Every batched cue for one connection from one frame. Packed with a few presence bits per cue so that unset references
+ * and normals cost nothing.
+ */
+USTRUCT()
+struct GASDOCUMENTATION_API FGDGameplayCueBatch
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FGDBatchedGameplayCue> Cues;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGDGameplayCueBatch> : public TStructOpsTypeTraitsBase2<FGDGameplayCueBatch>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/**
+ * Replaces the one multicast RPC per executed GameplayCue (like GameplayCue.Hero.FireGun.Impact) with one unreliable client RPC
+ * per connection per frame. Executed cues with a tag in BatchedCueTags are taken out of the GameplayCueManager's pending cues by
+ * UGDGameplayCueManager and queued here. At the end of the frame each remote player gets only the cues whose target is net relevant
+ * to it. Cosmetic emitters (like the throwable projectile's impact) can be queued directly.
+ * Cues from abilities that play them locally on the instigating client (UGDGameplayAbility::PredictsImpactCues()) aren't sent
+ * back to that client. Cues with a valid PredictionKey keep the engine's RPC, which already skips the predicting client.
+ * Only used on Dedicated and Listen Servers. Listen Servers execute the cues locally right away.
+ */
+UCLASS(Config = Game)
+class GASDOCUMENTATION_API UGDGameplayCueBatchSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UGDGameplayCueBatchSubsystem();
+
+	// Executed GameplayCues to batch. Any other cue in the same pending execute keeps the engine's RPC.
+	UPROPERTY(Config)
+	TArray<FName> BatchedCueTags;
+
+	// Larger batches are split over several RPCs to stay well under the unreliable bunch size
+	UPROPERTY(Config)
+	int32 MaxCuesPerBatch;
+
+	// Relevancy distance for emitters that aren't attached to an actor
+	UPROPERTY(Config)
+	float EmitterCullDistance;
+
+	static UGDGameplayCueBatchSubsystem* Get(const UObject* WorldContextObject);
+
+	// True if the Tags should be queued here instead of sent by the GameplayCueManager
+	bool ShouldBatchCues(const UAbilitySystemComponent* OwningComponent, const TArray<FGameplayTag>& Tags) const;
+
+	// Server only. Queues executed cues on the OwningComponent's avatar for the end of the frame.
+	void QueueGameplayCues(UAbilitySystemComponent* OwningComponent, const TArray<FGameplayTag>& Tags, const FGameplayCueParameters& Parameters);
+
+	// Server only. Spawns the Emitter on every client that the location (or RelevantActor if set and replicated) is relevant to.
+	void QueueEmitter(UParticleSystem* Emitter, const FVector& Location, AActor* RelevantActor = nullptr);
+
+	// Sends everything queued so far. Called automatically once per frame.
+	void FlushQueuedCues();
+
+	// Client side of AGDPlayerController::ClientExecuteGameplayCueBatch()
+	void ExecuteBatch(UWorld* World, const FGDGameplayCueBatch& Batch) const;
+
+	static void ExecuteCue(UWorld* World, const FGDBatchedGameplayCue& Cue);
+
+	// Implement USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Implement FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+	struct FGDQueuedGameplayCue
+	{
+		FGDBatchedGameplayCue Cue;
+
+		// The instigating player that already played the cue itself
+		TWeakObjectPtr<AController> PredictingController;
+	};
+
+	TArray<FGDQueuedGameplayCue> QueuedCues;
+
+	FGameplayTagContainer BatchedCueTagContainer;
+
+	// Batching only helps when there are remote connections to send to
+	bool IsBatchingWorld(const UWorld* World) const;
+
+	bool IsRelevantTo(const FGDQueuedGameplayCue& QueuedCue, AGDPlayerController* PlayerController, const FVector& ViewLocation) const;
+
+	void SendBatch(AGDPlayerController* PlayerController, FGDGameplayCueBatch& Batch);
+};
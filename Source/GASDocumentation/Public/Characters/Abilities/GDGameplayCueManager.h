@@ -0,0 +1,20 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayCueManager.h"
+#include "GDGameplayCueManager.generated.h"
+
+/**
+ * Hands executed GameplayCues that the GDGameplayCueBatchSubsystem batches over to it instead of sending one multicast RPC each.
+ * Set as the GlobalGameplayCueManagerClass in DefaultGame.ini.
+ */
+UCLASS()
+class GASDOCUMENTATION_API UGDGameplayCueManager : public UGameplayCueManager
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ProcessPendingCueExecute(FGameplayCuePendingExecute& PendingCue) override;
+};
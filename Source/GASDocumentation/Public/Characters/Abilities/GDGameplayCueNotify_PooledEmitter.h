@@ -0,0 +1,31 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayCueNotify_Static.h"
+#include "GDFXPoolSubsystem.h"
+#include "GDGameplayCueNotify_PooledEmitter.generated.h"
+
+class UParticleSystem;
+
+/**
+ * Static GameplayCue that plays an emitter at the hit location through the GDFXPoolSubsystem. Impact cues that only spawn an
+ * emitter (like GC_FireGunImpact) can be reparented to this and their graph removed to stop allocating a component per hit.
+ */
+UCLASS()
+class GASDOCUMENTATION_API UGDGameplayCueNotify_PooledEmitter : public UGameplayCueNotify_Static
+{
+	GENERATED_BODY()
+
+public:
+	UGDGameplayCueNotify_PooledEmitter();
+
+	UPROPERTY(EditDefaultsOnly, Category = "GameplayCue")
+	UParticleSystem* Emitter;
+
+	UPROPERTY(EditDefaultsOnly, Category = "GameplayCue")
+	EGDFXPriority Priority;
+
+	virtual bool OnExecute_Implementation(AActor* MyTarget, const FGameplayCueParameters& Parameters) const override;
+};
@@ -0,0 +1,53 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "GameplayEffectTypes.h"
+#include "GDGameplayEffectTypes.generated.h"
+
+/**
+ * Effect context that replicates a quantized impact location and normal instead of the whole FHitResult. The full hit result
+ * is still kept locally on the machine that added it. Clients get a hit result rebuilt from the quantized data so that
+ * GameplayCues can keep using GetHitResult(). Allocated by UGDAbilitySystemGlobals.
+ */
+USTRUCT()
+struct GASDOCUMENTATION_API FGDGameplayEffectContext : public FGameplayEffectContext
+{
+	GENERATED_BODY()
+
+public:
+	virtual UScriptStruct* GetScriptStruct() const override
+	{
+		return FGDGameplayEffectContext::StaticStruct();
+	}
+
+	virtual FGDGameplayEffectContext* Duplicate() const override
+	{
+		FGDGameplayEffectContext* NewContext = new FGDGameplayEffectContext();
+		*NewContext = *this;
+		NewContext->AddActors(Actors);
+		if (GetHitResult())
+		{
+			// Does a deep copy of the hit result
+			NewContext->AddHitResult(*GetHitResult(), true);
+		}
+		return NewContext;
+	}
+
+	virtual bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess) override;
+
+	// Bits the base FGameplayEffectContext and this would use to replicate the same context. Needs a real package map.
+	static void MeasureNetSerialize(const FGDGameplayEffectContext& Context, UPackageMap* Map, int64& OutBaseBits, int64& OutCompactBits);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGDGameplayEffectContext> : public TStructOpsTypeTraitsBase2<FGDGameplayEffectContext>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithCopy = true
+	};
+};
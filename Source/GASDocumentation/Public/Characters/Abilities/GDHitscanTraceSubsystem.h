@@ -0,0 +1,67 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionQueryParams.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/World.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "GDHitscanTraceSubsystem.generated.h"
+
+// Hit is the first blocking hit, or a hit result with only TraceStart and TraceEnd set if nothing was hit
+DECLARE_DELEGATE_OneParam(FGDHitscanTraceDelegate, const FHitResult& /*Hit*/);
+
+/**
+ * Collects the line traces of hitscan weapons from every shooter during a frame and issues them together as async traces
+ * once per frame, so that they run as one parallel batch with the rest of the world's async traces instead of blocking
+ * the game thread in each ability. Results are delivered on the game thread when the async traces complete, usually next frame.
+ */
+UCLASS()
+class GASDOCUMENTATION_API UGDHitscanTraceSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	static UGDHitscanTraceSubsystem* Get(const AActor* Actor);
+
+	void QueueLineTrace(const FVector& Start, const FVector& End, ECollisionChannel TraceChannel, const FCollisionQueryParams& QueryParams, const FGDHitscanTraceDelegate& OnComplete);
+
+	// Issues everything queued so far. Called automatically once per frame.
+	void FlushPendingTraces();
+
+	int32 GetNumPendingTraces() const;
+
+	// Implement USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Implement FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+	struct FGDHitscanTraceRequest
+	{
+		FVector Start;
+		FVector End;
+		ECollisionChannel TraceChannel;
+		FCollisionQueryParams QueryParams;
+		FGDHitscanTraceDelegate OnComplete;
+	};
+
+	TArray<FGDHitscanTraceRequest> PendingTraces;
+
+	// Async trace UserData to the callback waiting for it
+	TMap<uint32, FGDHitscanTraceDelegate> InFlightTraces;
+
+	uint32 NextTraceId;
+
+	// Shared by every async trace so that it is only bound once
+	FTraceDelegate TraceCompleteDelegate;
+
+	void OnTraceComplete(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+};
@@ -0,0 +1,94 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "GDRegenSubsystem.generated.h"
+
+class UGDAbilitySystemComponent;
+class UGDAttributeSetBase;
+
+/**
+ * Server side Health, Mana and Stamina regeneration for every registered ASC in one batched update at UpdatesPerSecond, instead of
+ * periodic regen GameplayEffects that each run a full execute and PostGameplayEffectExecute per character per period.
+ * Regen is accumulated per character and only written to the attribute's base value (which notifies the attribute change
+ * delegates and replicates) when the value crosses a multiple of NotifyThreshold or reaches its max.
+ * Disabled by default. Remove the periodic regen GameplayEffects (like GE_HealthManaStaminaRegenVolume) from characters before
+ * enabling it or regen is applied twice.
+ */
+UCLASS(Config = Game)
+class GASDOCUMENTATION_API UGDRegenSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UGDRegenSubsystem();
+
+	UPROPERTY(Config)
+	bool bEnabled;
+
+	UPROPERTY(Config)
+	float UpdatesPerSecond;
+
+	// Attributes are only written when they cross a multiple of this, like every whole point shown in the UI
+	UPROPERTY(Config)
+	float NotifyThreshold;
+
+	static UGDRegenSubsystem* Get(const AActor* Actor);
+
+	// Server only. Registering twice is ignored.
+	void RegisterAbilitySystemComponent(UGDAbilitySystemComponent* AbilitySystemComponent);
+
+	void UnregisterAbilitySystemComponent(UGDAbilitySystemComponent* AbilitySystemComponent);
+
+	// Integrates DeltaTime seconds of regen for every registered ASC
+	void UpdateRegen(float DeltaTime);
+
+	// Implement USubsystem
+	virtual void Deinitialize() override;
+
+	// Implement FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+	enum EGDRegenResource : uint8
+	{
+		GDRR_Health,
+		GDRR_Mana,
+		GDRR_Stamina,
+		GDRR_Num
+	};
+
+	// One resource of every registered ASC, indexed like AbilitySystemComponents
+	struct FGDRegenChannel
+	{
+		TArray<float> Values;
+		TArray<float> MaxValues;
+		TArray<float> Rates;
+
+		// Regen that hasn't been written to the attribute yet
+		TArray<float> Pending;
+	};
+
+	TArray<TWeakObjectPtr<UGDAbilitySystemComponent>> AbilitySystemComponents;
+
+	// Resolved lazily since the attribute set may not be registered with the ASC yet when it registers here. Weak so that a
+	// set that is garbage collected before its ASC unregisters is resolved again instead of dangling.
+	TArray<TWeakObjectPtr<UGDAttributeSetBase>> AttributeSets;
+
+	FGDRegenChannel Channels[GDRR_Num];
+
+	float TimeSinceLastUpdate;
+
+	void RemoveAtSwap(int32 Index);
+
+	// Reads the current attribute values into the channels. Returns false for entries that shouldn't regen this update.
+	bool GatherValues(int32 Index);
+
+	void CommitValues(int32 Index, const bool* bShouldCommit);
+};
@@ -62,10 +62,10 @@ public:
 	int32 GetCharacterLevel() const;
 
 	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|GDCharacter|Attributes")
-	float GetHealth() const;
+	virtual float GetHealth() const;
 
 	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|GDCharacter|Attributes")
-	float GetMaxHealth() const;
+	virtual float GetMaxHealth() const;
 
 	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|GDCharacter|Attributes")
 	float GetMana() const;
@@ -81,7 +81,7 @@ public:
 	
 	// Gets the Current value of MoveSpeed
 	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|GDCharacter|Attributes")
-	float GetMoveSpeed() const;
+	virtual float GetMoveSpeed() const;
 
 	// Gets the Base value of MoveSpeed
 	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|GDCharacter|Attributes")
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "GameplayTagContainer.h"
 #include "GDCharacterMovementComponent.generated.h"
 
 /**
@@ -34,12 +35,19 @@ class GASDOCUMENTATION_API UGDCharacterMovementComponent : public UCharacterMove
 		virtual void SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, class FNetworkPredictionData_Client_Character & ClientData) override;
 		///@brief Sets variables on character movement component before making a predictive correction.
 		virtual void PrepMoveFor(class ACharacter* Character) override;
+		///@brief Reverts the sprint state to the start of the OldMove that this move is combined with.
+		virtual void CombineWith(const FSavedMove_Character* OldMove, ACharacter* InCharacter, APlayerController* PC, const FVector& OldStartLocation) override;
 
 		// Sprint
 		uint8 SavedRequestToStartSprinting : 1;
 
 		// Aim Down Sights
 		uint8 SavedRequestToStartADS : 1;
+
+		// Sprint time not yet drained from Stamina at the start of the move
+		float SavedPendingSprintDrainSeconds;
+
+		uint8 SavedSprintStaminaDepleted : 1;
 	};
 
 	class FGDNetworkPredictionData_Client : public FNetworkPredictionData_Client_Character
@@ -59,6 +67,11 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sprint")
 	float SprintSpeedMultiplier;
 
+	// Stamina drained per second of sprinting, computed from the predicted sprint flag instead of a periodic GameplayEffect.
+	// The drain is only written to the Stamina attribute (on the Server) when sprinting stops or Stamina runs out. 0 disables it.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sprint")
+	float SprintStaminaDrainPerSecond;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Aim Down Sights")
 	float ADSSpeedMultiplier;
 
@@ -68,6 +81,7 @@ public:
 	virtual float GetMaxSpeed() const override;
 	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
 	virtual class FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+	virtual void OnMovementUpdated(float DeltaSeconds, const FVector& OldLocation, const FVector& OldVelocity) override;
 
 	// Sprint
 	UFUNCTION(BlueprintCallable, Category = "Sprint")
@@ -75,9 +89,29 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Sprint")
 	void StopSprinting();
 
+	// Stamina including the sprint drain that hasn't been committed to the attribute yet. Use this for UI while sprinting.
+	UFUNCTION(BlueprintCallable, Category = "Sprint")
+	float GetPredictedStamina() const;
+
 	// Aim Down Sights
 	UFUNCTION(BlueprintCallable, Category = "Aim Down Sights")
 	void StartAimDownSights();
 	UFUNCTION(BlueprintCallable, Category = "Aim Down Sights")
 	void StopAimDownSights();
+
+protected:
+	// Seconds sprinted since the drain was last committed. Restored from saved moves when the client replays moves.
+	float PendingSprintDrainSeconds;
+
+	// Set when Stamina runs out while sprinting. Moves that still request sprinting are ignored until one doesn't, since the
+	// client keeps sending the sprint flag until it hears that its sprint ability was cancelled.
+	uint8 bSprintStaminaDepleted : 1;
+
+	FGameplayTagContainer SprintAbilityTags;
+
+	// Accumulates the sprint drain for a move. Stops sprinting and commits when Stamina runs out or sprinting stopped.
+	void UpdateSprintStamina(float DeltaSeconds);
+
+	// Applies the pending drain to Stamina on the Server, without a GameplayEffect execution
+	void CommitSprintStamina();
 };
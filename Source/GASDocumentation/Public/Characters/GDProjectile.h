@@ -25,7 +25,43 @@ public:
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
 	class UProjectileMovementComponent* ProjectileMovement;
 
+	// Identifies the shot across the Server and the predicting client. Built from the ability's activation prediction key and the shot index.
+	static int32 MakePredictionId(const struct FPredictionKey& PredictionKey, int32 ShotIndex);
+
+	// Set on the Server's projectile and replicated to the owning client so that it can find its predicted projectile
+	UPROPERTY(Replicated)
+	int32 PredictionId;
+
+	// Marks this as a local, cosmetic only projectile that the owning client spawned ahead of the Server's projectile. Call before FinishSpawning().
+	void InitPredictedProjectile(int32 InPredictionId);
+
+	// Predicted projectiles are cosmetic only. Blueprints should not apply damage from them.
+	UFUNCTION(BlueprintCallable, Category = "Projectile")
+	bool IsPredictedProjectile() const;
+
+	// Destroys a predicted projectile if the Server rejected the ability activation that spawned it
+	void OnPredictionRejected();
+
+	// Executed locally when a predicted projectile overlaps a character, in place of the Server's cue that isn't sent back to us
+	UPROPERTY(BlueprintReadWrite, Category = "Projectile")
+	FGameplayTag PredictedImpactCueTag;
+
+	virtual void NotifyActorBeginOverlap(AActor* OtherActor) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 protected:
+	bool bIsPredictedProjectile;
+
+	bool bPlayedPredictedImpactCue;
+
+	// On the owning client, the predicted projectile that the Server's projectile is hidden behind
+	TWeakObjectPtr<AGDProjectile> PredictedProjectile;
+
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	class AGDHeroCharacter* GetLocallyControlledHeroInstigator() const;
 };
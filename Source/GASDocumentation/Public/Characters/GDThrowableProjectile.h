@@ -47,6 +47,6 @@ protected:
 	UFUNCTION()
 	void OnCollisionOccured(UPrimitiveComponent* OverlappedComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
 
-	UFUNCTION(NetMulticast, Reliable)
-	void SpawnEmitterEffect(const FVector& AtLocation);
+	// Batched with the frame's other cosmetic cues by the GDGameplayCueBatchSubsystem instead of a reliable multicast per impact
+	void SpawnEmitterEffect(AActor* HitActor);
 };
@@ -34,6 +34,8 @@ public:
 	/** Actually activate ability, do not call this directly. We'll call it from APAHeroCharacter::ActivateAbilitiesWithTags(). */
 	virtual void ActivateAbility(const FGameplayAbilitySpecHandle Handle, const FGameplayAbilityActorInfo* ActorInfo, const FGameplayAbilityActivationInfo ActivationInfo, const FGameplayEventData* TriggerEventData) override;
 
+	virtual bool PredictsImpactCues() const override;
+
 protected:
 	UPROPERTY(BlueprintReadOnly, EditAnywhere)
 	float Range;
@@ -41,12 +43,48 @@ protected:
 	UPROPERTY(BlueprintReadOnly, EditAnywhere)
 	float Damage;
 
-	UFUNCTION()
-	void OnCancelled(FGameplayTag EventTag, FGameplayEventData EventData);
+	// Shots fired per activation. Every shot after the first replays the fire montage on the same task instead of reactivating the ability.
+	// Cost and cooldown are committed once per activation. See UGDGA_FireGunBurst.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, meta = (ClampMin = "1"))
+	int32 ShotsPerActivation;
+
+	int32 ShotsFired;
+
+	// The owning client spawns a cosmetic projectile immediately instead of waiting a round trip for the Server's projectile.
+	// The Server's projectile is hidden behind it when it arrives. Measure the difference with Net PktLag and GD.Projectile.ShotDelay.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere)
+	bool bPredictProjectiles;
+
+	// Executed by predicted projectiles when they hit a character. Must match the cue on DamageGameplayEffect since the Server
+	// doesn't send that cue back to the predicting client.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, meta = (EditCondition = "bPredictProjectiles"))
+	FGameplayTag ImpactCueTag;
+
+	// Traces from the muzzle to Range and applies DamageGameplayEffect to the hit actor instead of spawning a projectile.
+	// Traces from every shooter are batched into async traces by the GDHitscanTraceSubsystem.
+	UPROPERTY(BlueprintReadOnly, EditAnywhere)
+	bool bHitscan;
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, meta = (EditCondition = "bHitscan"))
+	TEnumAsByte<ECollisionChannel> HitscanTraceChannel;
+
+	UPROPERTY()
+	UGDAT_PlayMontageAndWaitForEvent* FireMontageTask;
+
+	FGameplayTag SpawnProjectileEventTag;
+	FGameplayTag EndAbilityEventTag;
+
+	UAnimMontage* GetFireMontage() const;
+
+	// Fires the next shot of the activation on the existing montage task or ends the ability after the last one
+	void FinishShot();
+
+	// Bound to the montage task's native delegates so that event payloads are not copied
+	void OnCancelled(FGameplayTag EventTag, const FGameplayEventData& EventData);
+
+	void OnCompleted(FGameplayTag EventTag, const FGameplayEventData& EventData);
 
-	UFUNCTION()
-	void OnCompleted(FGameplayTag EventTag, FGameplayEventData EventData);
+	void EventReceived(FGameplayTag EventTag, const FGameplayEventData& EventData);
 
-	UFUNCTION()
-	void EventReceived(FGameplayTag EventTag, FGameplayEventData EventData);
+	void OnHitscanTraceComplete(const FHitResult& Hit, FGameplayEffectSpecHandle DamageEffectSpecHandle);
 };
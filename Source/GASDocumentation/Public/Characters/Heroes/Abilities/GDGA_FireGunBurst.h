@@ -0,0 +1,22 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Characters/Heroes/Abilities/GDGA_FireGun.h"
+#include "GDGA_FireGunBurst.generated.h"
+
+/**
+ * FireGun that fires a three round burst per activation. Every shot after the first restarts the montage on the same
+ * UGDAT_PlayMontageAndWaitForEvent, which the Montage Tasks Created and Montage Task Restarts counters in stat GASDocumentation
+ * show. A separate ability so that the regular FireGun keeps one shot per activation. Needs a Blueprint child with the montages,
+ * projectile and damage set like GA_FireGun's.
+ */
+UCLASS()
+class GASDOCUMENTATION_API UGDGA_FireGunBurst : public UGDGA_FireGun
+{
+	GENERATED_BODY()
+
+public:
+	UGDGA_FireGunBurst();
+};
@@ -52,6 +52,17 @@ public:
 
 	virtual void FinishDying() override;
 
+	// Projectile prediction on the locally controlled client, keyed by AGDProjectile::PredictionId
+	void RegisterPredictedProjectile(class AGDProjectile* Projectile);
+	class AGDProjectile* TakePredictedProjectile(int32 PredictionId);
+	// Called when a predicted projectile ends play before the Server's projectile took it (rejected, expired, or hit something)
+	void UnregisterPredictedProjectile(class AGDProjectile* Projectile);
+
+	// Measures the time from a fire event on the locally controlled client until the player sees the projectile
+	void NotifyProjectileShotFired(int32 PredictionId);
+	void NotifyProjectileShotVisible(int32 PredictionId);
+	void LogProjectileShotDelay() const;
+
 protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GASDocumentation|Camera")
 	float BaseTurnRate = 45.0f;
@@ -74,8 +85,9 @@ protected:
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
 	USkeletalMeshComponent* GunComponent;
 
+	// Soft reference so that the widget Blueprint is loaded asynchronously instead of in the constructor
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GASDocumentation|UI")
-	TSubclassOf<class UGDFloatingStatusBarWidget> UIFloatingStatusBarClass;
+	TSoftClassPtr<class UGDFloatingStatusBarWidget> UIFloatingStatusBarClass;
 
 	UPROPERTY()
 	class UGDFloatingStatusBarWidget* UIFloatingStatusBar;
@@ -87,6 +99,13 @@ protected:
 
 	FGameplayTag DeadTag;
 
+	TMap<int32, TWeakObjectPtr<class AGDProjectile>> PredictedProjectiles;
+
+	TMap<int32, double> PendingProjectileShotTimes;
+	int32 NumMeasuredProjectileShots;
+	double TotalProjectileShotDelay;
+	double LastProjectileShotDelay;
+
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
@@ -0,0 +1,78 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Characters/Minions/GDMinionCharacter.h"
+#include "Characters/Minions/GDMassMinionSubsystem.h"
+#include "GDMassMinionCharacter.generated.h"
+
+/**
+ * A lightweight minion for large crowds. It doesn't create an AbilitySystemComponent or AttributeSet.
+ * Its attributes live in the GDMassMinionSubsystem's attribute table on the Server and only Health and MaxHealth replicate.
+ * If a mass minion needs real abilities or GameplayEffects, the Server can promote it to a full AbilitySystemComponent.
+ */
+UCLASS()
+class GASDOCUMENTATION_API AGDMassMinionCharacter : public AGDMinionCharacter
+{
+	GENERATED_BODY()
+
+public:
+	AGDMassMinionCharacter(const class FObjectInitializer& ObjectInitializer);
+
+	virtual void InitializeAbilitySystem() override;
+
+	// Creates an AbilitySystemComponent and AttributeSet for this minion, carrying over its current Health. Can only be called by the Server.
+	// Returns true if the minion has an AbilitySystemComponent afterwards.
+	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|Minions")
+	virtual bool PromoteToAbilitySystem();
+
+	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|Minions")
+	bool IsPromoted() const;
+
+	int32 GetMassMinionIndex() const;
+
+	// Called by the GDMassMinionSubsystem after a damage GameplayEffectSpec was resolved against this minion's row in the attribute table
+	virtual void MassDamageReceived(const FGameplayEffectSpec& Spec, float DamageDone, float NewHealth, bool bWasAlive);
+
+	virtual float GetHealth() const override;
+	virtual float GetMaxHealth() const override;
+	virtual float GetMoveSpeed() const override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+protected:
+	// Used when DefaultAttributes doesn't override an attribute with a static magnitude
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category = "GASDocumentation|Minions")
+	FGDMassMinionAttributes DefaultMassAttributes;
+
+	UPROPERTY(ReplicatedUsing = OnRep_MassHealth)
+	float MassHealth;
+
+	UPROPERTY(Replicated)
+	float MassMaxHealth;
+
+	// Not replicated, resolved from the same class defaults on every machine
+	float MassMoveSpeed;
+
+	int32 MassMinionIndex;
+
+	UPROPERTY(ReplicatedUsing = OnRep_PromotedAbilitySystem)
+	class UGDAbilitySystemComponent* PromotedAbilitySystemComponent;
+
+	UPROPERTY(ReplicatedUsing = OnRep_PromotedAbilitySystem)
+	class UGDAttributeSetBase* PromotedAttributeSetBase;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Reads the static Override magnitudes out of DefaultAttributes, falling back to DefaultMassAttributes
+	FGDMassMinionAttributes ResolveDefaultMassAttributes() const;
+
+	UFUNCTION()
+	virtual void OnRep_MassHealth();
+
+	UFUNCTION()
+	virtual void OnRep_PromotedAbilitySystem();
+
+	class UGDMassMinionSubsystem* GetMassMinionSubsystem() const;
+};
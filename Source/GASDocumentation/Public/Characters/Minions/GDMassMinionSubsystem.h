@@ -0,0 +1,165 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayEffect.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "GDMassMinionSubsystem.generated.h"
+
+class AGDMassMinionCharacter;
+class AGDMinionCharacter;
+
+// The subset of GDAttributeSetBase that a mass minion needs
+USTRUCT(BlueprintType)
+struct GASDOCUMENTATION_API FGDMassMinionAttributes
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GASDocumentation|Minions")
+	float Health;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GASDocumentation|Minions")
+	float MaxHealth;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GASDocumentation|Minions")
+	float Armor;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GASDocumentation|Minions")
+	float MoveSpeed;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GASDocumentation|Minions")
+	float XPBounty;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GASDocumentation|Minions")
+	float GoldBounty;
+
+	FGDMassMinionAttributes()
+		: Health(100.0f), MaxHealth(100.0f), Armor(0.0f), MoveSpeed(300.0f), XPBounty(0.0f), GoldBounty(0.0f)
+	{}
+};
+
+/**
+ * Attributes for every mass minion stored as a structure of arrays, indexed by the minion's MassMinionIndex.
+ * Removed indices are recycled so that the arrays stay densely packed.
+ */
+struct GASDOCUMENTATION_API FGDMassMinionAttributeTable
+{
+	TArray<float> Health;
+	TArray<float> MaxHealth;
+	TArray<float> Armor;
+	TArray<float> MoveSpeed;
+	TArray<float> XPBounty;
+	TArray<float> GoldBounty;
+	TArray<TWeakObjectPtr<AGDMassMinionCharacter>> Minions;
+
+	TArray<int32> FreeIndices;
+
+	int32 Add(AGDMassMinionCharacter* Minion, const FGDMassMinionAttributes& Attributes);
+
+	void Remove(int32 Index);
+
+	bool IsValidIndex(int32 Index) const;
+
+	FGDMassMinionAttributes Get(int32 Index) const;
+
+	// Number of minions currently in the table, not counting recycled indices
+	int32 Num() const;
+
+	SIZE_T GetAllocatedSize() const;
+};
+
+/**
+ * Owns the attribute table for mass minions (GDMassMinionCharacter), which don't have an AbilitySystemComponent of their own.
+ * Damage GameplayEffectSpecs aimed at mass minions are resolved here with the same mitigation as GDDamageExecCalculation.
+ * Also owns the GD.MassMinion.Benchmark console command which compares the full and the mass representation.
+ */
+UCLASS(Config = Game)
+class GASDOCUMENTATION_API UGDMassMinionSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UGDMassMinionSubsystem();
+
+	// Minion class with a full AbilitySystemComponent used by GD.MassMinion.Benchmark
+	UPROPERTY(Config)
+	TSoftClassPtr<AGDMinionCharacter> BenchmarkFullMinionClass;
+
+	// Mass minion class used by GD.MassMinion.Benchmark
+	UPROPERTY(Config)
+	TSoftClassPtr<AGDMinionCharacter> BenchmarkMassMinionClass;
+
+	// Number of frames that GD.MassMinion.Benchmark samples for each representation
+	UPROPERTY(Config)
+	int32 BenchmarkFrames;
+
+	// Adds the minion to the attribute table. Returns its MassMinionIndex.
+	int32 RegisterMinion(AGDMassMinionCharacter* Minion, const FGDMassMinionAttributes& Attributes);
+
+	void UnregisterMinion(int32 MassMinionIndex);
+
+	const FGDMassMinionAttributeTable& GetAttributeTable() const;
+
+	// Mass minions only take the SetByCaller Data.Damage of an instant GameplayEffectSpec. Returns false and logs a warning (once
+	// per GameplayEffect) for other specs, like stuns, heals or damage over time, which mass minions don't support.
+	bool IsSupportedEffectSpec(const FGameplayEffectSpec& Spec);
+
+	// Resolves a damage GameplayEffectSpec (SetByCaller Data.Damage) against the minion's row in the table. Server only.
+	// Returns the mitigated damage that was subtracted from the minion's Health. Unsupported specs are rejected.
+	float ApplyDamageEffectSpec(int32 MassMinionIndex, const FGameplayEffectSpec& Spec);
+
+	// Subtracts damage that was already mitigated against the minion's Armor, like by UGDDamageExecCalculation::ApplyDamageBatch()
+	void ApplyMitigatedDamage(int32 MassMinionIndex, const FGameplayEffectSpec& Spec, float MitigatedDamage);
+
+	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|Minions")
+	int32 GetNumMassMinions() const;
+
+	// Spawns NumMinions of each representation in turn and logs the memory and game thread cost of each
+	void StartBenchmark(UWorld* World, int32 NumMinions);
+
+	// Implement USubsystem
+	virtual void Deinitialize() override;
+
+	// Implement FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+	FGDMassMinionAttributeTable AttributeTable;
+
+	FGameplayTag DamageTag;
+
+	// GameplayEffects that were already reported as unsupported
+	TSet<TWeakObjectPtr<const UGameplayEffect>> UnsupportedEffects;
+
+	enum class EBenchmarkPhase : uint8
+	{
+		None,
+		Baseline,
+		Full,
+		Mass
+	};
+
+	struct FBenchmarkSample
+	{
+		uint64 UsedPhysicalMemory = 0;
+		int32 NumObjects = 0;
+		double SpawnSeconds = 0.0;
+		double GameThreadMilliseconds = 0.0;
+	};
+
+	EBenchmarkPhase BenchmarkPhase;
+	int32 BenchmarkNumMinions;
+	int32 BenchmarkFramesSampled;
+	TWeakObjectPtr<UWorld> BenchmarkWorld;
+	TArray<TWeakObjectPtr<AActor>> BenchmarkActors;
+	FBenchmarkSample BenchmarkSamples[3];
+
+	void SpawnBenchmarkMinions(TSoftClassPtr<AGDMinionCharacter> MinionClass, FBenchmarkSample& Sample);
+	void DestroyBenchmarkMinions();
+	void LogBenchmarkResults() const;
+};
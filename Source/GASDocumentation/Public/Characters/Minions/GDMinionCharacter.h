@@ -18,6 +18,15 @@ class GASDOCUMENTATION_API AGDMinionCharacter : public AGDCharacterBase
 public:
 	AGDMinionCharacter(const class FObjectInitializer& ObjectInitializer);
 
+	// Initializes the AbilitySystemComponent's ActorInfo, attributes, startup effects, abilities, and callbacks.
+	// Called from BeginPlay unless the minion was spawned by the GDMinionWaveSubsystem, which spreads this out over multiple frames.
+	// Safe to call many times because it checks to make sure it only executes once.
+	virtual void InitializeAbilitySystem();
+
+	bool IsAbilitySystemInitialized() const;
+
+	TSoftClassPtr<class UGDFloatingStatusBarWidget> GetFloatingStatusBarClass() const;
+
 protected:
 
 	// Actual hard pointer to AbilitySystemComponent
@@ -30,8 +39,9 @@ protected:
 	
 	virtual void BeginPlay() override;
 	
+	// Soft reference so that the widget Blueprint can be loaded asynchronously instead of in the constructor
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GASDocumentation|UI")
-	TSubclassOf<class UGDFloatingStatusBarWidget> UIFloatingStatusBarClass;
+	TSoftClassPtr<class UGDFloatingStatusBarWidget> UIFloatingStatusBarClass;
 
 	UPROPERTY()
 	class UGDFloatingStatusBarWidget* UIFloatingStatusBar;
@@ -41,9 +51,23 @@ protected:
 
 	FDelegateHandle HealthChangedDelegateHandle;
 
+	bool AbilitySystemInitialized;
+
+	// Set by the GDMinionWaveSubsystem before FinishSpawning so that BeginPlay leaves InitializeAbilitySystem to the subsystem
+	bool DeferAbilitySystemInitialization;
+
+	// Creates and initializes the floating status bar for minions. If the widget class isn't loaded yet, it is loaded asynchronously
+	// and the widget is created when it finishes. Safe to call many times because it checks to make sure it only executes once.
+	UFUNCTION()
+	void InitializeFloatingStatusBar();
+
 	// Attribute changed callbacks
 	virtual void HealthChanged(const FOnAttributeChangeData& Data);
 
 	// Tag change callbacks
 	virtual void StunTagChanged(const FGameplayTag CallbackTag, int32 NewCount);
+
+private:
+
+	friend class UGDMinionWaveSubsystem;
 };
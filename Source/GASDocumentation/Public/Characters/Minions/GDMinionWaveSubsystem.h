@@ -0,0 +1,78 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Queue.h"
+#include "Engine/StreamableManager.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "GDMinionWaveSubsystem.generated.h"
+
+class AGDMinionCharacter;
+
+/**
+ * Spawns waves of minions on the Server without a frame spike at the start of the wave.
+ * Minion classes (and their floating status bar widget classes) are loaded asynchronously. Spawning and AbilitySystemComponent
+ * initialization (attributes, startup effects, abilities) are then spread over multiple frames under a per frame time budget.
+ */
+UCLASS(Config = Game)
+class GASDOCUMENTATION_API UGDMinionWaveSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UGDMinionWaveSubsystem();
+
+	// Time in milliseconds per frame that spawning and initializing minions is allowed to take
+	UPROPERTY(Config, BlueprintReadWrite, Category = "GASDocumentation|Minions")
+	float FrameBudgetMilliseconds;
+
+	// Always spawn or initialize at least this many minions per frame so that waves still finish on slow machines
+	UPROPERTY(Config, BlueprintReadWrite, Category = "GASDocumentation|Minions")
+	int32 MinOperationsPerFrame;
+
+	// Starts loading the minion class and its floating status bar widget class so that a later wave doesn't have to wait on them.
+	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|Minions")
+	void PreloadMinionClass(TSoftClassPtr<AGDMinionCharacter> MinionClass);
+
+	// Queues a minion to be spawned at each of the SpawnTransforms. Can only be called by the Server. Returns the number of minions queued.
+	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|Minions")
+	int32 SpawnWave(TSoftClassPtr<AGDMinionCharacter> MinionClass, const TArray<FTransform>& SpawnTransforms);
+
+	// Minions that are queued to spawn or spawned but waiting on their AbilitySystemComponent to be initialized
+	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|Minions")
+	int32 GetNumPendingMinions() const;
+
+	// Implement USubsystem
+	virtual void Deinitialize() override;
+
+	// Implement FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+	struct FGDPendingMinionSpawn
+	{
+		TSoftClassPtr<AGDMinionCharacter> MinionClass;
+		FTransform Transform;
+	};
+
+	TQueue<FGDPendingMinionSpawn> PendingSpawns;
+	int32 NumPendingSpawns;
+
+	TQueue<TWeakObjectPtr<AGDMinionCharacter>> PendingInitializations;
+	int32 NumPendingInitializations;
+
+	// Keeps preloaded classes in memory for as long as the subsystem lives
+	TMap<FSoftObjectPath, TSharedPtr<FStreamableHandle>> PreloadHandles;
+
+	void OnMinionClassLoaded(TSoftClassPtr<AGDMinionCharacter> MinionClass);
+
+	// Spawns the minion with its AbilitySystemComponent initialization deferred. Returns false if it has to wait for the class to load.
+	bool SpawnNextMinion();
+
+	void InitializeNextMinion();
+};
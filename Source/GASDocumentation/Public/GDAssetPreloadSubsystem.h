@@ -0,0 +1,88 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "GDAssetPreloadSubsystem.generated.h"
+
+/**
+ * Asynchronously loads the classes that used to be loaded with StaticLoadClass in constructors (hero, floating status bars, damage text).
+ * Loading starts when the GameInstance initializes and again before every map load, including travel, so that it overlaps with the map
+ * load instead of hitching the first frames of gameplay. Soft class references that aren't loaded when gameplay needs them fall back to a counted
+ * synchronous load. GD.Preload.Report logs the timings and the number of synchronous loads.
+ */
+UCLASS(Config = Game)
+class GASDOCUMENTATION_API UGDAssetPreloadSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Classes to preload on every machine
+	UPROPERTY(Config)
+	TArray<FSoftClassPath> PreloadClasses;
+
+	// Classes to preload everywhere except Dedicated Servers, like widgets
+	UPROPERTY(Config)
+	TArray<FSoftClassPath> ClientPreloadClasses;
+
+	// Returns the soft class if it is loaded. Otherwise loads it synchronously and counts it so that it shows up in the report.
+	template<typename T>
+	static TSubclassOf<T> ResolveClass(const UObject* WorldContextObject, const TSoftClassPtr<T>& SoftClass)
+	{
+		UClass* Class = SoftClass.Get();
+		if (!Class && !SoftClass.IsNull())
+		{
+			Class = LoadClassSynchronously(WorldContextObject, SoftClass.ToSoftObjectPath());
+		}
+
+		return Class;
+	}
+
+	static UClass* LoadClassSynchronously(const UObject* WorldContextObject, const FSoftObjectPath& ClassPath);
+
+	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|Loading")
+	bool IsPreloadComplete() const;
+
+	// Number of synchronous loads that happened after a map finished loading and before the next one started
+	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|Loading")
+	int32 GetNumGameplaySyncLoads() const;
+
+	void LogReport() const;
+
+	// Implement USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+protected:
+	TSharedPtr<FStreamableHandle> PreloadHandle;
+
+	double PreloadStartTime;
+	double PreloadSeconds;
+	int32 NumPreloaded;
+	int32 NumPreloadRuns;
+
+	double MapLoadStartTime;
+	double MapLoadEndTime;
+	double MapLoadSeconds;
+	FString LastMapName;
+
+	// Measured time the last preload kept running after its map finished loading, 0 if it finished during the map load
+	double PreloadSecondsAfterMapLoad;
+
+	bool bGameplayStarted;
+	int32 NumGameplaySyncLoads;
+	TArray<FSoftObjectPath> GameplaySyncLoads;
+
+	FDelegateHandle PreLoadMapDelegateHandle;
+	FDelegateHandle PostLoadMapDelegateHandle;
+
+	void StartPreload();
+
+	void OnPreloadComplete();
+
+	void OnPreLoadMap(const FString& MapName);
+
+	void OnPostLoadMap(UWorld* LoadedWorld);
+};
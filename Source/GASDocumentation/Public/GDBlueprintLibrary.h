@@ -16,5 +16,15 @@ class GASDOCUMENTATION_API UGDBlueprintLibrary : public UBlueprintFunctionLibrar
 	GENERATED_BODY()
 
 public:
+	// Applies the GameplayEffectSpec to the TargetActor's AbilitySystemComponent. Mass minions don't have one
+	// so their damage is resolved against the GDMassMinionSubsystem's attribute table instead. Any other effect
+	// is rejected for mass minions with a warning. Server only.
+	// Abilities must apply their effects through this (or ApplyDamageEffectSpecToActors) to reach mass minions.
+	// The engine's ApplyGameplayEffectSpecToTarget skips actors without an AbilitySystemComponent.
+	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|Abilities")
+	static void ApplyGameplayEffectSpecToActor(const FGameplayEffectSpecHandle& SpecHandle, AActor* TargetActor);
 
+	// Applies a damage GameplayEffectSpec to every TargetActor in one UGDDamageExecCalculation damage batch. Server only.
+	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|Abilities")
+	static void ApplyDamageEffectSpecToActors(const FGameplayEffectSpecHandle& SpecHandle, const TArray<AActor*>& TargetActors);
 };
@@ -0,0 +1,131 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Templates/Atomic.h"
+#include "GDCombatEventSubsystem.generated.h"
+
+class FGDCombatEventWriter;
+
+UENUM()
+enum class EGDCombatEventType : uint8
+{
+	// Value is the mitigated damage, Value2 the unmitigated damage (0 for mass minions)
+	Damage,
+	// Target died
+	Death,
+	// Source is awarded Value XP and Value2 Gold for killing Target
+	Bounty,
+	// Value is the EGDHitReactDirection
+	HitReact
+};
+
+// Fixed size record that is copied into the ring buffer and written to the combat log as is
+struct FGDCombatEventRecord
+{
+	// World time in seconds
+	float Time;
+
+	// Per log ids of the actors assigned in order from 1 (see ActorIds and NextActorId), not GetUniqueID(). 0 if there was none.
+	// The combat log's .actors.csv maps them to names and classes.
+	uint32 SourceId;
+	uint32 TargetId;
+
+	float Value;
+	float Value2;
+
+	// Target location
+	float X;
+	float Y;
+	float Z;
+
+	uint8 Type;
+	uint8 Padding[3];
+};
+
+static_assert(sizeof(FGDCombatEventRecord) == 36, "FGDCombatEventRecord is written to combat logs as is. Bump the combat log version when changing it.");
+
+/**
+ * Lock free ring buffer with a single producer (the game thread) and a single consumer (the combat log writer thread).
+ * Push() never blocks or allocates. Records are dropped if the writer falls behind by more than the capacity.
+ */
+class GASDOCUMENTATION_API FGDCombatEventRingBuffer
+{
+public:
+	// Capacity is rounded up to a power of two
+	void Init(uint32 Capacity);
+
+	// Producer only. Returns false if the buffer is full.
+	bool Push(const FGDCombatEventRecord& Record);
+
+	// Consumer only. Copies up to MaxRecords into OutRecords and returns how many were copied.
+	int32 Pop(FGDCombatEventRecord* OutRecords, int32 MaxRecords);
+
+private:
+	TArray<FGDCombatEventRecord> Records;
+	uint32 Mask;
+
+	// Next index to write. Only written by the producer.
+	TAtomic<uint32> Head;
+
+	// Next index to read. Only written by the consumer.
+	TAtomic<uint32> Tail;
+};
+
+/**
+ * Records damage, death, bounty and hit react events into a lock free ring buffer. A background thread streams them to a
+ * compact binary file in Saved/CombatLogs so that fights can be analyzed offline without file IO on the game thread.
+ * Start and stop with GD.CombatLog.Start and GD.CombatLog.Stop or bRecordOnStart in DefaultGame.ini. Server only events.
+ */
+UCLASS(Config = Game)
+class GASDOCUMENTATION_API UGDCombatEventSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(Config)
+	bool bRecordOnStart;
+
+	// Number of records the ring buffer can hold before the writer thread has to catch up
+	UPROPERTY(Config)
+	int32 RingBufferCapacity;
+
+	// Cheap no-op unless recording. Game thread only.
+	static void Record(EGDCombatEventType Type, const AActor* Source, const AActor* Target, float Value = 0.0f, float Value2 = 0.0f);
+
+	void StartRecording();
+
+	void StopRecording();
+
+	bool IsRecording() const;
+
+	// Implement USubsystem
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+protected:
+	FGDCombatEventRingBuffer RingBuffer;
+
+	TUniquePtr<FGDCombatEventWriter> Writer;
+	FRunnableThread* WriterThread;
+
+	FString LogFilename;
+
+	// Actors seen in this log, written next to it when recording stops
+	TMap<uint32, FString> RecordedActors;
+
+	// Ids are assigned in order per log instead of using GetUniqueID(), which is reused once an actor is garbage collected
+	TMap<TWeakObjectPtr<const AActor>, uint32> ActorIds;
+	uint32 NextActorId;
+
+	int32 NumRecorded;
+	int32 NumDropped;
+
+	uint32 GetActorId(const AActor* Actor);
+
+	void PushRecord(EGDCombatEventType Type, const AActor* Source, const AActor* Target, float Value, float Value2);
+
+	void WriteActorTable() const;
+};
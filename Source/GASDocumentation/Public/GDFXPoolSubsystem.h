@@ -0,0 +1,135 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "GDFXPoolSubsystem.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+
+UENUM(BlueprintType)
+enum class EGDFXPriority : uint8
+{
+	// Dropped when over the frame's budget or far from the local view, like impacts in a crowd
+	Low,
+	// Always played, like feedback for the local player's own hits
+	High
+};
+
+USTRUCT()
+struct GASDOCUMENTATION_API FGDPooledEmitterPreallocation
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TSoftObjectPtr<UParticleSystem> Emitter;
+
+	UPROPERTY()
+	int32 Count = 0;
+};
+
+/**
+ * Client side pool for impact effects. Particle system components are created per emitter template, reused when they finish
+ * instead of being spawned and destroyed per impact, and low priority effects are dropped past MaxLowPriorityEffectsPerFrame or
+ * LowPriorityCullDistance. The configured emitters are preallocated a few per frame after a map loads. GameplayCueNotify_Actors
+ * are preallocated by the engine instead, through NumPreallocatedInstances on the cue's Blueprint.
+ * Does nothing on Dedicated Servers. GD.FXPool.Stats logs the pool sizes and how many effects were reused and dropped.
+ */
+UCLASS(Config = Game)
+class GASDOCUMENTATION_API UGDFXPoolSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UGDFXPoolSubsystem();
+
+	UPROPERTY(Config)
+	TArray<FGDPooledEmitterPreallocation> PreallocatedEmitters;
+
+	UPROPERTY(Config)
+	int32 MaxLowPriorityEffectsPerFrame;
+
+	UPROPERTY(Config)
+	float LowPriorityCullDistance;
+
+	// Components per emitter template. Low priority effects are dropped when they're all playing, high priority effects spawn unpooled.
+	UPROPERTY(Config)
+	int32 MaxPooledEmittersPerTemplate;
+
+	// Components created per frame while preallocating so that preallocation isn't a spike of its own
+	UPROPERTY(Config)
+	int32 PreallocationsPerFrame;
+
+	static UGDFXPoolSubsystem* Get(const UObject* WorldContextObject);
+
+	// Plays the Template from the pool. Returns null if the effect was dropped or on Dedicated Servers.
+	UParticleSystemComponent* SpawnEmitter(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation, EGDFXPriority Priority);
+
+	// Like UGameplayStatics::SpawnEmitterAtLocation() but pooled and budgeted. Falls back to an unpooled emitter without the subsystem.
+	UFUNCTION(BlueprintCallable, Category = "GASDocumentation|Effects", meta = (WorldContext = "WorldContextObject"))
+	static UParticleSystemComponent* SpawnPooledEmitterAtLocation(const UObject* WorldContextObject, UParticleSystem* Template, FVector Location,
+		FRotator Rotation, EGDFXPriority Priority = EGDFXPriority::Low);
+
+	void LogStats() const;
+
+	// Implement USubsystem
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Implement FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+	struct FGDEmitterPool
+	{
+		TArray<UParticleSystemComponent*> FreeComponents;
+		int32 NumComponents = 0;
+	};
+
+	TMap<UParticleSystem*, FGDEmitterPool> EmitterPools;
+
+	// Keeps the pooled components alive. Cleared with the world they were created in.
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> PooledComponents;
+
+	TWeakObjectPtr<UWorld> PoolWorld;
+
+	bool bPreallocationComplete;
+
+	TSharedPtr<FStreamableHandle> PreallocationLoadHandle;
+
+	FDelegateHandle WorldCleanupDelegateHandle;
+
+	uint64 BudgetFrame;
+	int32 NumLowPriorityEffectsThisFrame;
+
+	int32 NumSpawned;
+	int32 NumReused;
+	int32 NumAllocated;
+	int32 NumDropped;
+	int32 NumUnpooled;
+
+	// Starts pooling for the current world if it changed since the last call. Returns false if there's no world to pool in.
+	bool UpdatePoolWorld();
+
+	void ResetPools();
+
+	void UpdatePreallocation();
+
+	UParticleSystemComponent* CreatePooledComponent(UWorld* World, UParticleSystem* Template, FGDEmitterPool& Pool);
+
+	bool ShouldDropLowPriorityEffect(UWorld* World, const FVector& Location);
+
+	UFUNCTION()
+	void OnPooledEmitterFinished(UParticleSystemComponent* ParticleSystemComponent);
+
+	void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+};
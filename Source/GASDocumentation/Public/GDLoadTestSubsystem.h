@@ -0,0 +1,114 @@
+// Copyright 2019 Dan Kestranek.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GASDocumentation.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Tickable.h"
+#include "GDLoadTestSubsystem.generated.h"
+
+class AGDHeroAIController;
+class AGDHeroCharacter;
+class UNetConnection;
+
+// Ability input that every load test hero presses at a fixed rate
+USTRUCT()
+struct FGDLoadTestInput
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Config)
+	EGDAbilityInputID InputID = EGDAbilityInputID::None;
+
+	UPROPERTY(Config)
+	float PressesPerSecond = 1.0f;
+
+	// Seconds between pressing and releasing the input, for held abilities like sprint
+	UPROPERTY(Config)
+	float HoldSeconds = 0.0f;
+
+	// Seconds between pressing the input and confirming, for targeted abilities like meteor. Never confirms if negative.
+	UPROPERTY(Config)
+	float ConfirmSeconds = -1.0f;
+};
+
+/**
+ * Server load test. Spawns heroes possessed by AGDHeroAIControllers that only move and aim. Their abilities are driven by the
+ * scripted Inputs instead, through the same input path as players (AbilityLocalInputPressed/Released). At the end of the run it
+ * logs the server frame time percentiles, GE applications per second and bytes sent per connection.
+ * Start from the command line with -GDLoadTest=<NumHeroes> [-GDLoadTestSeconds=<Seconds>] [-GDLoadTestExit], or with GD.LoadTest.Start.
+ */
+UCLASS(Config = Game)
+class GASDOCUMENTATION_API UGDLoadTestSubsystem : public UGameInstanceSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	UGDLoadTestSubsystem();
+
+	// Preloaded by the GDAssetPreloadSubsystem during map load
+	UPROPERTY(Config)
+	TSoftClassPtr<AGDHeroCharacter> HeroClass;
+
+	UPROPERTY(Config)
+	TArray<FGDLoadTestInput> Inputs;
+
+	// Heroes are spawned in this radius around the player starts
+	UPROPERTY(Config)
+	float SpawnRadius;
+
+	// Used when the run length isn't given
+	UPROPERTY(Config)
+	float DefaultDurationSeconds;
+
+	static UGDLoadTestSubsystem* Get(const AActor* Actor);
+
+	// Starts a load test if the command line asks for one. Called by the GameMode on BeginPlay.
+	void StartFromCommandLine();
+
+	void StartLoadTest(int32 NumHeroes, float DurationSeconds, bool bExitWhenDone);
+
+	// Ends the run, logs the report and destroys the spawned heroes
+	void StopLoadTest();
+
+	bool IsRunning() const;
+
+	// Implement USubsystem
+	virtual void Deinitialize() override;
+
+	// Implement FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+
+protected:
+	struct FGDLoadTestBot
+	{
+		TWeakObjectPtr<AGDHeroAIController> Controller;
+
+		// Per entry in Inputs
+		TArray<double> NextPressTimes;
+		TArray<double> ReleaseTimes;
+		TArray<double> ConfirmTimes;
+	};
+
+	TArray<FGDLoadTestBot> Bots;
+
+	bool bRunning;
+	bool bExitWhenDone;
+	double StartTime;
+	double EndTime;
+
+	// Game thread milliseconds of every frame of the run
+	TArray<float> FrameTimes;
+
+	TMap<TWeakObjectPtr<UNetConnection>, uint32> StartOutBytes;
+
+	void SpawnBot(const FTransform& SpawnTransform);
+
+	void UpdateBotInputs(FGDLoadTestBot& Bot, double Now);
+
+	void LogReport() const;
+};
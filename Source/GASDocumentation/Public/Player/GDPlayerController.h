@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
 #include "GDCharacterBase.h"
+#include "GDGameplayCueBatchSubsystem.h"
 #include "GDPlayerController.generated.h"
 
 /**
@@ -16,10 +17,13 @@ class GASDOCUMENTATION_API AGDPlayerController : public APlayerController
 	GENERATED_BODY()
 	
 public:
+	AGDPlayerController();
+
 	void CreateHUD();
 
+	// Preloaded by the GDAssetPreloadSubsystem during map load instead of synchronously loaded when the HUD is created
 	UPROPERTY(EditAnywhere, Category = "GASDocumentation|UI")
-	TSubclassOf<class UGDDamageTextWidgetComponent> DamageNumberClass;
+	TSoftClassPtr<class UGDDamageTextWidgetComponent> DamageNumberClass;
 
 	class UGDHUDWidget* GetHUD();
 
@@ -34,6 +38,11 @@ public:
 	void SetRespawnCountdown_Implementation(float RespawnTimeRemaining);
 	bool SetRespawnCountdown_Validate(float RespawnTimeRemaining);
 
+	// This frame's batched GameplayCues that are relevant to this player. Cosmetic only so it's fine to drop.
+	UFUNCTION(Client, Unreliable)
+	void ClientExecuteGameplayCueBatch(const FGDGameplayCueBatch& Batch);
+	void ClientExecuteGameplayCueBatch_Implementation(const FGDGameplayCueBatch& Batch);
+
 protected:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category = "GASDocumentation|UI")
 	TSubclassOf<class UGDHUDWidget> UIHUDWidgetClass;